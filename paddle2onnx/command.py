@@ -107,6 +107,68 @@ def arg_parser():
         type=ast.literal_eval,
         default=True,
         help="whether enable auto_update_opset, default is True")
+    parser.add_argument(
+        "--enable_fused_attention",
+        type=ast.literal_eval,
+        default=False,
+        help="whether fuse the attention blocks into MultiHeadAttention of onnxruntime(domain com.microsoft), only works while --enable_dev_version=True, default False"
+    )
+    parser.add_argument(
+        "--target_profile",
+        type=_text_type,
+        default="standard",
+        choices=["standard", "onnxruntime-cpu"],
+        help="the inference engine of the exported model, the fused operators of onnxruntime(domain com.microsoft) will be used with onnxruntime-cpu, only works while --enable_dev_version=True, default standard"
+    )
+    parser.add_argument(
+        "--loop_unroll_threshold",
+        type=int,
+        default=0,
+        help="the while loops with constant trip count no more than this threshold will be unrolled, 0 means disabled, only works while --enable_dev_version=True, default 0"
+    )
+    parser.add_argument(
+        "--export_fp16_model",
+        type=ast.literal_eval,
+        default=False,
+        help="whether convert the weights and computation to float16, only works while --enable_dev_version=True, default False"
+    )
+    parser.add_argument(
+        "--fp16_keep_io_types",
+        type=ast.literal_eval,
+        default=True,
+        help="whether keep the inputs and outputs in float32 while exporting float16 model, default True"
+    )
+    parser.add_argument(
+        "--fp16_keep_ops",
+        type=_text_type,
+        default="layer_norm,softmax,reduce_sum,exp",
+        help="the PaddlePaddle operators stay in float32 while exporting float16 model, separated by comma, default layer_norm,softmax,reduce_sum,exp"
+    )
+    parser.add_argument(
+        "--weight_quantize_type",
+        type=_text_type,
+        default="none",
+        choices=["none", "int8", "int4"],
+        help="quantize the large weights to int8 or int4(MatMulNBits of onnxruntime, only works while --target_profile=onnxruntime-cpu), only works while --enable_dev_version=True, default none"
+    )
+    parser.add_argument(
+        "--weight_quantize_threshold",
+        type=int,
+        default=65536,
+        help="the weights with at least this number of elements will be quantized, default 65536"
+    )
+    parser.add_argument(
+        "--weight_quantize_pattern",
+        type=_text_type,
+        default="",
+        help="the regular expression of weight names to be quantized, empty means all the weights, default empty"
+    )
+    parser.add_argument(
+        "--dim_param_dict",
+        type=_text_type,
+        default="None",
+        help="name the dynamic dimensions of inputs and outputs, the dimensions with the same name are known as equal by the runtimes, empty name means the dimension is named automatically, only works while --enable_dev_version=True, e.g --dim_param_dict=\"{'input_ids': ['batch', 'seq_len'], 'logits': ['batch', 'seq_len', '']}\""
+    )
     return parser
 
 
@@ -118,11 +180,32 @@ def c_paddle_to_onnx(model_file,
                      verbose=True,
                      enable_onnx_checker=True,
                      enable_experimental_op=True,
-                     enable_optimize=True):
+                     enable_optimize=True,
+                     enable_fused_attention=False,
+                     target_profile="standard",
+                     loop_unroll_threshold=0,
+                     input_shapes=None,
+                     export_fp16_model=False,
+                     fp16_keep_io_types=True,
+                     fp16_keep_ops=None,
+                     weight_quantize_type="none",
+                     weight_quantize_threshold=65536,
+                     weight_quantize_pattern="",
+                     dim_params=None):
     import paddle2onnx.paddle2onnx_cpp2py_export as c_p2o
+    if input_shapes is None:
+        input_shapes = dict()
+    if fp16_keep_ops is None:
+        fp16_keep_ops = ["layer_norm", "softmax", "reduce_sum", "exp"]
+    if dim_params is None:
+        dim_params = dict()
     onnx_model_str = c_p2o.export(
         model_file, params_file, opset_version, auto_upgrade_opset, verbose,
-        enable_onnx_checker, enable_experimental_op, enable_optimize)
+        enable_onnx_checker, enable_experimental_op, enable_optimize,
+        enable_fused_attention, target_profile, loop_unroll_threshold,
+        input_shapes, export_fp16_model, fp16_keep_io_types, fp16_keep_ops,
+        weight_quantize_type, weight_quantize_threshold,
+        weight_quantize_pattern, dim_params)
     if save_file is not None:
         with open(save_file, "wb") as f:
             f.write(onnx_model_str)
@@ -231,6 +314,7 @@ def main():
     assert args.save_file is not None, "--save_file should be defined while translating paddle model to onnx"
 
     input_shape_dict = eval(args.input_shape_dict)
+    dim_param_dict = eval(args.dim_param_dict)
 
     operator_export_type = "ONNX"
     if args.enable_paddle_fallback:
@@ -250,10 +334,6 @@ def main():
         if args.output_names is not None:
             logging.warn(
                 "--output_names is deprecated while --enable_dev_version=True.")
-        if input_shape_dict is not None:
-            logging.warn(
-                "--input_shape_dict is deprecated while --enable_dev_version=True."
-            )
         model_file = os.path.join(args.model_dir, args.model_filename)
         if args.params_filename is None:
             params_file = ""
@@ -268,7 +348,21 @@ def main():
             verbose=True,
             enable_onnx_checker=args.enable_onnx_checker,
             enable_experimental_op=True,
-            enable_optimize=True)
+            enable_optimize=True,
+            enable_fused_attention=args.enable_fused_attention,
+            target_profile=args.target_profile,
+            loop_unroll_threshold=args.loop_unroll_threshold,
+            input_shapes=input_shape_dict,
+            export_fp16_model=args.export_fp16_model,
+            fp16_keep_io_types=args.fp16_keep_io_types,
+            fp16_keep_ops=[
+                op.strip() for op in args.fp16_keep_ops.split(",")
+                if op.strip() != ""
+            ],
+            weight_quantize_type=args.weight_quantize_type,
+            weight_quantize_threshold=args.weight_quantize_threshold,
+            weight_quantize_pattern=args.weight_quantize_pattern,
+            dim_params=dim_param_dict)
 
     program2onnx(
         args.model_dir,
@@ -20,54 +20,93 @@
 
 namespace paddle2onnx {
 
-PADDLE2ONNX_DECL bool IsExportable(
-    const std::string& model, const std::string& params,
-    bool from_memory_buffer, int32_t opset_version, bool auto_upgrade_opset,
-    bool verbose, bool enable_onnx_checker, bool enable_experimental_op,
-    bool enable_optimize) {
+PADDLE2ONNX_DECL bool IsExportable(const std::string& model,
+                                   const std::string& params,
+                                   const ExportOptions& options,
+                                   bool from_memory_buffer) {
   auto parser = PaddleParser();
   if (!parser.Init(model, params, from_memory_buffer)) {
     return false;
   }
+  if (!parser.SetInputShapes(options.input_shapes)) {
+    return false;
+  }
   paddle2onnx::ModelExporter me;
   std::set<std::string> unsupported_ops;
   if (!me.CheckIfOpSupported(parser, &unsupported_ops,
-                             enable_experimental_op)) {
+                             options.enable_experimental_op)) {
     return false;
   }
   if (me.GetMinOpset(parser, false) < 0) {
     return false;
   }
-  std::string onnx_model =
-      me.Run(parser, opset_version, auto_upgrade_opset, verbose,
-             enable_onnx_checker, enable_experimental_op, enable_optimize);
+  std::string onnx_model = me.Run(parser, options);
   if (onnx_model.empty()) {
-    P2OLogger(verbose) << "The exported ONNX model is invalid!" << std::endl;
+    P2OLogger(options.verbose) << "The exported ONNX model is invalid!"
+                               << std::endl;
     return false;
   }
   return true;
 }
 
+PADDLE2ONNX_DECL bool IsExportable(const std::string& model,
+                                   const std::string& params,
+                                   bool from_memory_buffer,
+                                   int32_t opset_version,
+                                   bool auto_upgrade_opset, bool verbose,
+                                   bool enable_onnx_checker,
+                                   bool enable_experimental_op,
+                                   bool enable_optimize) {
+  ExportOptions options;
+  options.opset_version = opset_version;
+  options.auto_upgrade_opset = auto_upgrade_opset;
+  options.verbose = verbose;
+  options.enable_onnx_checker = enable_onnx_checker;
+  options.enable_experimental_op = enable_experimental_op;
+  options.enable_optimize = enable_optimize;
+  return IsExportable(model, params, options, from_memory_buffer);
+}
+
 PADDLE2ONNX_DECL bool Export(const std::string& model,
                              const std::string& params, std::string* out,
-                             bool from_memory_buffer, int32_t opset_version,
-                             bool auto_upgrade_opset, bool verbose,
-                             bool enable_onnx_checker,
-                             bool enable_experimental_op,
-                             bool enable_optimize) {
+                             const ExportOptions& options,
+                             bool from_memory_buffer) {
   auto parser = PaddleParser();
-  P2OLogger(verbose) << "Start to parsing Paddle model..." << std::endl;
+  P2OLogger(options.verbose) << "Start to parsing Paddle model..."
+                             << std::endl;
   if (!parser.Init(model, params, from_memory_buffer)) {
-    P2OLogger(verbose) << "Paddle model parsing failed." << std::endl;
+    P2OLogger(options.verbose) << "Paddle model parsing failed." << std::endl;
+    return false;
+  }
+  if (!parser.SetInputShapes(options.input_shapes)) {
+    P2OLogger(options.verbose) << "The specified input shapes are invalid."
+                               << std::endl;
     return false;
   }
   paddle2onnx::ModelExporter me;
-  *out = me.Run(parser, opset_version, auto_upgrade_opset, verbose,
-                enable_onnx_checker, enable_experimental_op, enable_optimize);
+  *out = me.Run(parser, options);
   if (out->empty()) {
-    P2OLogger(verbose) << "The exported ONNX model is invalid!" << std::endl;
+    P2OLogger(options.verbose) << "The exported ONNX model is invalid!"
+                               << std::endl;
     return false;
   }
   return true;
 }
+
+PADDLE2ONNX_DECL bool Export(const std::string& model,
+                             const std::string& params, std::string* out,
+                             bool from_memory_buffer, int32_t opset_version,
+                             bool auto_upgrade_opset, bool verbose,
+                             bool enable_onnx_checker,
+                             bool enable_experimental_op,
+                             bool enable_optimize) {
+  ExportOptions options;
+  options.opset_version = opset_version;
+  options.auto_upgrade_opset = auto_upgrade_opset;
+  options.verbose = verbose;
+  options.enable_onnx_checker = enable_onnx_checker;
+  options.enable_experimental_op = enable_experimental_op;
+  options.enable_optimize = enable_optimize;
+  return Export(model, params, out, options, from_memory_buffer);
+}
 }  // namespace paddle2onnx
@@ -12,7 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #pragma once
+#include <map>
 #include <string>
+#include <vector>
 
 #if defined(_WIN32)
 #ifdef PADDLE2ONNX_LIB
@@ -26,6 +28,31 @@
 
 namespace paddle2onnx {
 
+// The options of exporting, see the help of paddle2onnx command for details
+struct ExportOptions {
+  int32_t opset_version = 11;
+  bool auto_upgrade_opset = true;
+  bool verbose = false;
+  bool enable_onnx_checker = true;
+  bool enable_experimental_op = false;
+  bool enable_optimize = true;
+  bool enable_fused_attention = false;
+  std::string target_profile = "standard";
+  // The while loops with static trip count no more than this threshold are
+  // unrolled, 0 means disabled
+  int32_t loop_unroll_threshold = 0;
+  // Specialize the shapes of inputs, it's applied before exporting
+  std::map<std::string, std::vector<int64_t>> input_shapes;
+  bool export_fp16_model = false;
+  bool fp16_keep_io_types = true;
+  std::vector<std::string> fp16_keep_ops = {"layer_norm", "softmax",
+                                            "reduce_sum", "exp"};
+  std::string weight_quantize_type = "none";
+  int64_t weight_quantize_threshold = 65536;
+  std::string weight_quantize_pattern = "";
+  std::map<std::string, std::vector<std::string>> dim_params;
+};
+
 PADDLE2ONNX_DECL bool IsExportable(
     const std::string& model, const std::string& params,
     bool from_memory_buffer = false, int32_t opset_version = 11,
@@ -33,6 +60,11 @@ PADDLE2ONNX_DECL bool IsExportable(
     bool enable_onnx_checker = true, bool enable_experimental_op = false,
     bool enable_optimize = true);
 
+PADDLE2ONNX_DECL bool IsExportable(const std::string& model,
+                                   const std::string& params,
+                                   const ExportOptions& options,
+                                   bool from_memory_buffer = false);
+
 PADDLE2ONNX_DECL bool Export(
     const std::string& model, const std::string& params, std::string* out,
     bool from_memory_buffer = false, int32_t opset_version = 11,
@@ -40,4 +72,9 @@ PADDLE2ONNX_DECL bool Export(
     bool enable_onnx_checker = true, bool enable_experimental_op = false,
     bool enable_optimize = true);
 
+PADDLE2ONNX_DECL bool Export(const std::string& model,
+                             const std::string& params, std::string* out,
+                             const ExportOptions& options,
+                             bool from_memory_buffer = false);
+
 }  // namespace paddle2onnx
@@ -14,6 +14,7 @@
 
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <map>
 #include <string>
 #include <vector>
 #include "paddle2onnx/mapper/exporter.h"
@@ -27,7 +28,21 @@ PYBIND11_MODULE(paddle2onnx_cpp2py_export, m) {
                      bool auto_upgrade_opset = true, bool verbose = true,
                      bool enable_onnx_checker = true,
                      bool enable_experimental_op = true,
-                     bool enable_optimize = true) {
+                     bool enable_optimize = true,
+                     bool enable_fused_attention = false,
+                     const std::string& target_profile = "standard",
+                     int loop_unroll_threshold = 0,
+                     const std::map<std::string, std::vector<int64_t>>&
+                         input_shapes = {},
+                     bool export_fp16_model = false,
+                     bool fp16_keep_io_types = true,
+                     const std::vector<std::string>& fp16_keep_ops = {
+                         "layer_norm", "softmax", "reduce_sum", "exp"},
+                     const std::string& weight_quantize_type = "none",
+                     int64_t weight_quantize_threshold = 65536,
+                     const std::string& weight_quantize_pattern = "",
+                     const std::map<std::string, std::vector<std::string>>&
+                         dim_params = {}) {
     P2OLogger(verbose) << "Start to parse PaddlePaddle model(model file: "
                        << model_filename
                        << ", parameters file: " << params_filename << std::endl;
@@ -37,11 +52,29 @@ PYBIND11_MODULE(paddle2onnx_cpp2py_export, m) {
     } else {
       parser.Init(model_filename);
     }
+    Assert(parser.SetInputShapes(input_shapes),
+           "The specified input shapes are invalid.");
     P2OLogger(verbose) << "Model loaded, start to converting..." << std::endl;
+    ExportOptions options;
+    options.opset_version = opset_version;
+    options.auto_upgrade_opset = auto_upgrade_opset;
+    options.verbose = verbose;
+    options.enable_onnx_checker = enable_onnx_checker;
+    options.enable_experimental_op = enable_experimental_op;
+    options.enable_optimize = enable_optimize;
+    options.enable_fused_attention = enable_fused_attention;
+    options.target_profile = target_profile;
+    options.loop_unroll_threshold = loop_unroll_threshold;
+    options.input_shapes = input_shapes;
+    options.export_fp16_model = export_fp16_model;
+    options.fp16_keep_io_types = fp16_keep_io_types;
+    options.fp16_keep_ops = fp16_keep_ops;
+    options.weight_quantize_type = weight_quantize_type;
+    options.weight_quantize_threshold = weight_quantize_threshold;
+    options.weight_quantize_pattern = weight_quantize_pattern;
+    options.dim_params = dim_params;
     ModelExporter me;
-    auto onnx_proto =
-        me.Run(parser, opset_version, auto_upgrade_opset, verbose,
-               enable_onnx_checker, enable_experimental_op, enable_optimize);
+    auto onnx_proto = me.Run(parser, options);
     return pybind11::bytes(onnx_proto);
   });
 
@@ -184,6 +184,16 @@ void SwishMapper::Opset7() {
   auto input_info = GetInput("X");
   auto output_info = GetOutput("Out");
 
+  // QuickGelu computes x * Sigmoid(alpha * x)
+  if (helper_->IsOnnxRuntimeTarget() &&
+      input_info[0].dtype == P2ODataType::FP32) {
+    auto node = helper_->MakeNode("QuickGelu", {input_info[0].name},
+                                  {output_info[0].name});
+    node->set_domain("com.microsoft");
+    AddAttribute(node, "alpha", beta_);
+    return;
+  }
+
   std::string beta_node =
       helper_->Constant({1}, GetOnnxDtype(input_info[0].dtype), beta_);
   // TODO(jiangjiajun) eliminate multiply with a constant of value 1
@@ -198,6 +208,17 @@ void HardSwishMapper::Opset7() {
   auto input_info = GetInput("X");
   auto output_info = GetOutput("Out");
 
+  // x * Clip(x + offset, 0, threshold) / scale equals to
+  // x * HardSigmoid(x, alpha=1/scale, beta=offset/scale) if threshold == scale
+  if (fabs(threshold_ - scale_) < 1e-05) {
+    auto hard_sigmoid = helper_->MakeNode("HardSigmoid", {input_info[0].name});
+    AddAttribute(hard_sigmoid, "alpha", 1.0f / scale_);
+    AddAttribute(hard_sigmoid, "beta", offset_ / scale_);
+    helper_->MakeNode("Mul", {input_info[0].name, hard_sigmoid->output(0)},
+                      {output_info[0].name});
+    return;
+  }
+
   std::string scale_node =
       helper_->Constant({1}, GetOnnxDtype(input_info[0].dtype), scale_);
   std::string offset_node =
@@ -247,6 +268,15 @@ void GeluMapper::Opset9() {
   auto input_name = helper_->AutoCast(input_info[0].name, input_info[0].dtype,
                                       P2ODataType::FP32);
 
+  if (helper_->IsOnnxRuntimeTarget()) {
+    auto node = helper_->MakeNode(approximate_ ? "FastGelu" : "Gelu",
+                                  {input_name});
+    node->set_domain("com.microsoft");
+    helper_->AutoCast(node->output(0), output_info[0].name, P2ODataType::FP32,
+                      input_info[0].dtype);
+    return;
+  }
+
   // the computation formula follows
   // https://www.paddlepaddle.org.cn/documentation/docs/zh/api/paddle/nn/functional/gelu_cn.html#gelu
   auto erf0 = helper_->MakeNode("Div", {input_name, sqrt_2});
@@ -165,7 +165,11 @@ class GeluMapper : public Mapper {
  public:
   GeluMapper(const PaddleParser& p, OnnxHelper* helper, int64_t block_id,
              int64_t op_id)
-      : Mapper(p, helper, block_id, op_id) {}
+      : Mapper(p, helper, block_id, op_id) {
+    if (HasAttr("approximate")) {
+      GetAttr("approximate", &approximate_);
+    }
+  }
 
   int32_t GetMinOpset(bool verbose = false) {
     Logger(verbose, 9) << RequireOpset(9) << std::endl;
@@ -173,6 +177,9 @@ class GeluMapper : public Mapper {
   }
 
   void Opset9();
+
+ private:
+  bool approximate_ = false;
 };
 
 class SoftMaxMapper : public Mapper {
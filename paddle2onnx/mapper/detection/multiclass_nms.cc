@@ -195,16 +195,158 @@ void NMSMapper::KeepTopK(const std::string& selected_indices) {
                         P2ODataType::INT64, num_rois_info[0].dtype);
 }
 
-void NMSMapper::Opset10() {
+void NMSMapper::KeepTopKBatch(const std::string& selected_indices) {
   auto boxes_info = GetInput("BBoxes");
   auto score_info = GetInput("Scores");
-  if (boxes_info[0].shape[0] != 1) {
-    Warn()
-        << "[WARNING] Due to the operator multiclass_nms3, the exported ONNX "
-           "model will only supports inference with input batch_size == 1."
-        << std::endl;
-  }
+  auto out_info = GetOutput("Out");
+  auto index_info = GetOutput("Index");
+  auto num_rois_info = GetOutput("NmsRoisNum");
   int64_t num_classes = score_info[0].shape[1];
+  int64_t num_boxes = score_info[0].shape[2];
+  auto value_0 =
+      helper_->Constant({}, ONNX_NAMESPACE::TensorProto::INT64, int64_t(0));
+  auto value_1 =
+      helper_->Constant({}, ONNX_NAMESPACE::TensorProto::INT64, int64_t(1));
+
+  // selected_indices: [num_selected_indices, 3], and 3 means [batch_id,
+  // class_id, box_id], the result of NonMaxSuppression is sorted by batch_id
+  auto selected = selected_indices;
+  if (background_label_ >= 0) {
+    auto class_id = helper_->Slice(selected, {1}, {1}, {2});
+    class_id = helper_->Squeeze(class_id, {1});
+    auto background = helper_->Constant({1}, ONNX_NAMESPACE::TensorProto::INT64,
+                                        background_label_);
+    auto diff = helper_->MakeNode("Sub", {class_id, background});
+    auto filter_indices = helper_->MakeNode("NonZero", {diff->output(0)});
+    auto squeezed_filter_indices =
+        helper_->Squeeze(filter_indices->output(0), {0});
+    auto filtered =
+        helper_->MakeNode("Gather", {selected, squeezed_filter_indices});
+    AddAttribute(filtered, "axis", int64_t(0));
+    selected = filtered->output(0);
+  }
+  auto split_ids = helper_->Split(selected, {1, 1, 1}, 1);
+  auto batch_id = helper_->Squeeze(split_ids[0], {1});
+  auto class_id = helper_->Squeeze(split_ids[1], {1});
+  auto box_id = helper_->Squeeze(split_ids[2], {1});
+
+  // Gather scores from the flattened scores [N * C * M], the index is
+  //    `gather_index = (batch_id * C + class_id) * M + box_id`
+  auto flatten_score = helper_->Reshape(score_info[0].name, {-1});
+  auto num_classes_node = helper_->Constant(
+      {1}, ONNX_NAMESPACE::TensorProto::INT64, num_classes);
+  auto num_boxes_node =
+      helper_->Constant({1}, ONNX_NAMESPACE::TensorProto::INT64, num_boxes);
+  auto score_index = helper_->MakeNode("Mul", {batch_id, num_classes_node});
+  score_index = helper_->MakeNode("Add", {score_index->output(0), class_id});
+  score_index =
+      helper_->MakeNode("Mul", {score_index->output(0), num_boxes_node});
+  score_index = helper_->MakeNode("Add", {score_index->output(0), box_id});
+  auto score = helper_->MakeNode("Gather", {flatten_score,
+                                            score_index->output(0)})->output(0);
+
+  // Count the selected boxes of each image, while the batch_id is sorted
+  //    counts[i] = ReduceSum(batch_id == i)
+  auto batch_size = helper_->MakeNode("Shape", {score_info[0].name});
+  auto batch_size_scalar = helper_->Squeeze(
+      helper_->Slice(batch_size->output(0), {0}, {0}, {1}), {0});
+  auto batch_range = helper_->MakeNode(
+      "Range", {value_0, batch_size_scalar, value_1});
+  auto batch_range_node = helper_->Unsqueeze(batch_range->output(0), {1});
+  auto compute_counts = [&](const std::string& ids) -> std::string {
+    auto unsqueezed_ids = helper_->Unsqueeze(ids, {0});
+    auto equal = helper_->MakeNode("Equal", {unsqueezed_ids, batch_range_node});
+    auto counts = helper_->AutoCast(equal->output(0), P2ODataType::BOOL,
+                                    P2ODataType::INT64);
+    auto reduce_sum = helper_->MakeNode("ReduceSum", {counts});
+    AddAttribute(reduce_sum, "axes", std::vector<int64_t>(1, 1));
+    AddAttribute(reduce_sum, "keepdims", int64_t(0));
+    return reduce_sum->output(0);
+  };
+
+  std::string num_rois = "";
+  if (keep_top_k_ > 0) {
+    // Sort by score in descending order, then sort by batch_id in ascending
+    // order, TopK is stable since opset 11, so the boxes of each image are
+    // still in descending order of score
+    auto num_selected = helper_->MakeNode("Shape", {score});
+    auto score_topk =
+        helper_->MakeNode("TopK", {score, num_selected->output(0)}, 2);
+    auto score_order = score_topk->output(1);
+    auto score_sorted_batch_id =
+        helper_->MakeNode("Gather", {batch_id, score_order});
+    auto batch_topk = helper_->MakeNode(
+        "TopK", {score_sorted_batch_id->output(0), num_selected->output(0)},
+        2);
+    AddAttribute(batch_topk, "largest", int64_t(0));
+    auto order =
+        helper_->MakeNode("Gather", {score_order, batch_topk->output(1)});
+    auto sorted_batch_id =
+        helper_->MakeNode("Gather", {batch_id, order->output(0)})->output(0);
+
+    // rank of each box in its image is `position - start of the image`
+    auto counts = compute_counts(sorted_batch_id);
+    auto starts = helper_->MakeNode("CumSum", {counts, value_0});
+    AddAttribute(starts, "exclusive", int64_t(1));
+    auto box_starts =
+        helper_->MakeNode("Gather", {starts->output(0), sorted_batch_id});
+    auto num_selected_scalar = helper_->Squeeze(num_selected->output(0), {0});
+    auto positions =
+        helper_->MakeNode("Range", {value_0, num_selected_scalar, value_1});
+    auto rank = helper_->MakeNode(
+        "Sub", {positions->output(0), box_starts->output(0)});
+    auto top_k =
+        helper_->Constant({1}, ONNX_NAMESPACE::TensorProto::INT64, keep_top_k_);
+    auto keep = helper_->MakeNode("Less", {rank->output(0), top_k});
+    auto keep_indices = helper_->MakeNode("NonZero", {keep->output(0)});
+    auto squeezed_keep_indices = helper_->Squeeze(keep_indices->output(0), {0});
+    auto final_order = helper_->MakeNode(
+        "Gather", {order->output(0), squeezed_keep_indices});
+
+    auto gather = [&](const std::string& input) -> std::string {
+      return helper_->MakeNode("Gather", {input, final_order->output(0)})
+          ->output(0);
+    };
+    batch_id = gather(batch_id);
+    class_id = gather(class_id);
+    box_id = gather(box_id);
+    score = gather(score);
+
+    auto less = helper_->MakeNode("Less", {counts, top_k});
+    num_rois =
+        helper_->MakeNode("Where", {less->output(0), counts, top_k})->output(0);
+  } else {
+    num_rois = compute_counts(batch_id);
+  }
+
+  // Gather boxes from the flattened boxes [N * M, 4], the index is
+  //    `box_index = batch_id * M + box_id`
+  auto box_index = helper_->MakeNode("Mul", {batch_id, num_boxes_node});
+  box_index = helper_->MakeNode("Add", {box_index->output(0), box_id});
+  auto flatten_boxes = helper_->Reshape(boxes_info[0].name, {-1, 4});
+  auto selected_boxes =
+      helper_->MakeNode("Gather", {flatten_boxes, box_index->output(0)});
+  AddAttribute(selected_boxes, "axis", int64_t(0));
+
+  auto out_dtype = GetOnnxDtype(out_info[0].dtype);
+  auto float_classes = helper_->MakeNode("Cast", {class_id});
+  AddAttribute(float_classes, "to", out_dtype);
+  auto unsqueezed_classes = helper_->Unsqueeze(float_classes->output(0), {1});
+  auto unsqueezed_scores = helper_->Unsqueeze(score, {1});
+  helper_->Concat({unsqueezed_classes, unsqueezed_scores,
+                   selected_boxes->output(0)},
+                  out_info[0].name, 1);
+
+  auto reshaped_index = helper_->Reshape(box_index->output(0), {-1, 1});
+  helper_->AutoCast(reshaped_index, index_info[0].name, P2ODataType::INT64,
+                    index_info[0].dtype);
+  helper_->AutoCast(num_rois, num_rois_info[0].name, P2ODataType::INT64,
+                    num_rois_info[0].dtype);
+}
+
+std::string NMSMapper::NonMaxSuppression() {
+  auto boxes_info = GetInput("BBoxes");
+  auto score_info = GetInput("Scores");
   auto score_threshold = helper_->Constant(
       {1}, ONNX_NAMESPACE::TensorProto::FLOAT, score_threshold_);
   auto nms_threshold = helper_->Constant(
@@ -234,6 +376,27 @@ void NMSMapper::Opset10() {
                        nms_threshold, score_threshold},
                       {selected_box_index});
   }
-  KeepTopK(selected_box_index);
+  return selected_box_index;
+}
+
+void NMSMapper::Opset10() {
+  auto boxes_info = GetInput("BBoxes");
+  if (boxes_info[0].shape[0] != 1) {
+    Warn()
+        << "[WARNING] Due to the operator multiclass_nms3, the exported ONNX "
+           "model will only supports inference with input batch_size == 1, "
+           "export with opset_version >= 11 to support batch inference."
+        << std::endl;
+  }
+  KeepTopK(NonMaxSuppression());
+}
+
+void NMSMapper::Opset11() {
+  auto boxes_info = GetInput("BBoxes");
+  if (boxes_info[0].shape[0] == 1) {
+    KeepTopK(NonMaxSuppression());
+  } else {
+    KeepTopKBatch(NonMaxSuppression());
+  }
 }
 }  // namespace paddle2onnx
@@ -45,7 +45,11 @@ class NMSMapper : public Mapper {
 
   int32_t GetMinOpset(bool verbose = false);
   void KeepTopK(const std::string& selected_indices);
+  // Batch-aware version of KeepTopK, requires opset 11
+  void KeepTopKBatch(const std::string& selected_indices);
+  std::string NonMaxSuppression();
   void Opset10();
+  void Opset11();
 
  private:
   bool normalized_;
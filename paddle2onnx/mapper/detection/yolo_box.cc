@@ -40,17 +40,28 @@ void YoloBoxMapper::Opset11() {
   int64_t max_int = 999999;
 
   int64_t anchor_num = anchors_.size() / 2;
+  auto dtype = GetOnnxDtype(x_info[0].dtype);
 
-  auto x_shape = helper_->MakeNode("Shape", {x_info[0].name});
-  std::vector<std::string> nchw = helper_->Split(
-      x_shape->output(0), std::vector<int64_t>(4, 1), int64_t(0));
-  std::string float_h =
-      helper_->AutoCast(nchw[2], P2ODataType::INT64, x_info[0].dtype);
-  std::string float_w =
-      helper_->AutoCast(nchw[3], P2ODataType::INT64, x_info[0].dtype);
+  // While height and width of X are known, grid and anchors are computed while
+  // exporting, the graph only depends on the dynamic batch size
+  int64_t h = -1;
+  int64_t w = -1;
+  if (x_info[0].Rank() == 4) {
+    h = x_info[0].shape[2];
+    w = x_info[0].shape[3];
+  }
+  bool is_static = h > 0 && w > 0;
 
-  auto anchor_num_tensor =
-      helper_->Constant({1}, ONNX_NAMESPACE::TensorProto::INT64, anchor_num);
+  std::vector<std::string> nchw;
+  std::string float_h;
+  std::string float_w;
+  if (!is_static) {
+    auto x_shape = helper_->MakeNode("Shape", {x_info[0].name});
+    nchw = helper_->Split(x_shape->output(0), std::vector<int64_t>(4, 1),
+                          int64_t(0));
+    float_h = helper_->AutoCast(nchw[2], P2ODataType::INT64, x_info[0].dtype);
+    float_w = helper_->AutoCast(nchw[3], P2ODataType::INT64, x_info[0].dtype);
+  }
 
   auto x_name = x_info[0].name;
   if (iou_aware_) {
@@ -62,101 +73,132 @@ void YoloBoxMapper::Opset11() {
                             {max_int, anchor_num, max_int, max_int});
   }
 
-  auto unknown_dim =
-      helper_->Constant({1}, ONNX_NAMESPACE::TensorProto::INT64, int64_t(-1));
-  auto shape_0 = helper_->MakeNode(
-      "Concat", {nchw[0], anchor_num_tensor, unknown_dim, nchw[2], nchw[3]});
-  AddAttribute(shape_0, "axis", int64_t(0));
-  auto reshaped_x = helper_->MakeNode("Reshape", {x_name, shape_0->output(0)});
-  auto transposed_x = helper_->MakeNode("Transpose", {reshaped_x->output(0)});
+  std::string reshaped_x;
+  if (is_static) {
+    // 0 means copying the batch size from input
+    reshaped_x = helper_->Reshape(x_name, {0, anchor_num, -1, h, w});
+  } else {
+    auto anchor_num_tensor =
+        helper_->Constant({1}, ONNX_NAMESPACE::TensorProto::INT64, anchor_num);
+    auto unknown_dim =
+        helper_->Constant({1}, ONNX_NAMESPACE::TensorProto::INT64, int64_t(-1));
+    auto shape_0 = helper_->MakeNode(
+        "Concat", {nchw[0], anchor_num_tensor, unknown_dim, nchw[2], nchw[3]});
+    AddAttribute(shape_0, "axis", int64_t(0));
+    reshaped_x =
+        helper_->MakeNode("Reshape", {x_name, shape_0->output(0)})->output(0);
+  }
+  auto transposed_x = helper_->MakeNode("Transpose", {reshaped_x});
   {
     std::vector<int64_t> perm({0, 1, 3, 4, 2});
     AddAttribute(transposed_x, "perm", perm);
   }
 
-  // grid_x = np.tile(np.arange(w).reshape((1, w)), (h, 1))
-  // grid_y = np.tile(np.arange(h).reshape((h, 1)), (1, w))
-  auto float_value_0 =
-      helper_->Constant({}, GetOnnxDtype(x_info[0].dtype), float(0.0));
-  auto float_value_1 =
-      helper_->Constant({}, GetOnnxDtype(x_info[0].dtype), float(1.0));
-  auto scalar_float_w = helper_->Squeeze(float_w, {});
-  auto scalar_float_h = helper_->Squeeze(float_h, {});
-  auto grid_x_0 = helper_->MakeNode(
-      "Range", {float_value_0, scalar_float_w, float_value_1});  // shape is [w]
-  auto grid_y_0 = helper_->MakeNode(
-      "Range", {float_value_0, scalar_float_h, float_value_1});  // shape is [h]
-  auto grid_x_1 = helper_->MakeNode(
-      "Tile", {grid_x_0->output(0), nchw[2]});  // shape is [w*h]
-  auto grid_y_1 = helper_->MakeNode(
-      "Tile", {grid_y_0->output(0), nchw[3]});  // shape is [h*w]
-  auto int_value_1 =
-      helper_->Constant({1}, ONNX_NAMESPACE::TensorProto::INT64, float(1.0));
-  auto grid_shape_x =
-      helper_->MakeNode("Concat", {nchw[2], nchw[3], int_value_1});
-  auto grid_shape_y =
-      helper_->MakeNode("Concat", {nchw[3], nchw[2], int_value_1});
-  AddAttribute(grid_shape_x, "axis", int64_t(0));
-  AddAttribute(grid_shape_y, "axis", int64_t(0));
-  auto grid_x = helper_->MakeNode(
-      "Reshape", {grid_x_1->output(0), grid_shape_x->output(0)});
-  auto grid_y_2 = helper_->MakeNode(
-      "Reshape", {grid_y_1->output(0), grid_shape_y->output(0)});
-  auto grid_y = helper_->MakeNode("Transpose", {grid_y_2->output(0)});
-  {
-    std::vector<int64_t> perm({1, 0, 2});
-    AddAttribute(grid_y, "perm", perm);
-  }
-
-  auto grid =
-      helper_->MakeNode("Concat", {grid_x->output(0), grid_y->output(0)});
-  AddAttribute(grid, "axis", int64_t(2));
-
+  auto float_value_1 = helper_->Constant({}, dtype, float(1.0));
+  float bias_x_y_value = (1.0 - scale_x_y_) / 2.0;
   // pred_box[:, :, :, :, 0] = (grid_x + sigmoid(pred_box[:, :, :, :, 0]) *
   // scale_x_y + bias_x_y) / w pred_box[:, :, :, :, 1] = (grid_y +
   // sigmoid(pred_box[:, :, :, :, 1]) * scale_x_y + bias_x_y) / h
   auto pred_box_xy =
       helper_->Slice(transposed_x->output(0), {0, 1, 2, 3, 4}, {0, 0, 0, 0, 0},
                      {max_int, max_int, max_int, max_int, 2});
-  auto scale_x_y =
-      helper_->Constant({1}, GetOnnxDtype(x_info[0].dtype), scale_x_y_);
-  float bias_x_y_value = (1.0 - scale_x_y_) / 2.0;
-  auto bias_x_y =
-      helper_->Constant({1}, GetOnnxDtype(x_info[0].dtype), bias_x_y_value);
-  auto wh = helper_->MakeNode("Concat", {float_w, float_h});
-  AddAttribute(wh, "axis", int64_t(0));
   pred_box_xy = helper_->MakeNode("Sigmoid", {pred_box_xy})->output(0);
-  pred_box_xy = helper_->MakeNode("Mul", {pred_box_xy, scale_x_y})->output(0);
-  pred_box_xy = helper_->MakeNode("Add", {pred_box_xy, bias_x_y})->output(0);
-  pred_box_xy =
-      helper_->MakeNode("Add", {pred_box_xy, grid->output(0)})->output(0);
-  pred_box_xy =
-      helper_->MakeNode("Div", {pred_box_xy, wh->output(0)})->output(0);
+  std::string wh;
+  if (is_static) {
+    // pred_box_xy = sigmoid(x) * (scale_x_y / wh) + (grid + bias_x_y) / wh
+    std::vector<float> xy_scale = {scale_x_y_ / w, scale_x_y_ / h};
+    std::vector<float> xy_bias(h * w * 2);
+    for (int64_t i = 0; i < h; ++i) {
+      for (int64_t j = 0; j < w; ++j) {
+        xy_bias[(i * w + j) * 2] = (j + bias_x_y_value) / w;
+        xy_bias[(i * w + j) * 2 + 1] = (i + bias_x_y_value) / h;
+      }
+    }
+    auto scale_x_y = helper_->Assign(dtype, {2}, xy_scale);
+    auto grid = helper_->Assign(dtype, {h, w, 2}, xy_bias);
+    pred_box_xy = helper_->MakeNode("Mul", {pred_box_xy, scale_x_y})->output(0);
+    pred_box_xy = helper_->MakeNode("Add", {pred_box_xy, grid})->output(0);
+  } else {
+    // grid_x = np.tile(np.arange(w).reshape((1, w)), (h, 1))
+    // grid_y = np.tile(np.arange(h).reshape((h, 1)), (1, w))
+    auto float_value_0 = helper_->Constant({}, dtype, float(0.0));
+    auto scalar_float_w = helper_->Squeeze(float_w, {});
+    auto scalar_float_h = helper_->Squeeze(float_h, {});
+    auto grid_x_0 = helper_->MakeNode(
+        "Range",
+        {float_value_0, scalar_float_w, float_value_1});  // shape is [w]
+    auto grid_y_0 = helper_->MakeNode(
+        "Range",
+        {float_value_0, scalar_float_h, float_value_1});  // shape is [h]
+    auto grid_x_1 = helper_->MakeNode(
+        "Tile", {grid_x_0->output(0), nchw[2]});  // shape is [w*h]
+    auto grid_y_1 = helper_->MakeNode(
+        "Tile", {grid_y_0->output(0), nchw[3]});  // shape is [h*w]
+    auto int_value_1 =
+        helper_->Constant({1}, ONNX_NAMESPACE::TensorProto::INT64, float(1.0));
+    auto grid_shape_x =
+        helper_->MakeNode("Concat", {nchw[2], nchw[3], int_value_1});
+    auto grid_shape_y =
+        helper_->MakeNode("Concat", {nchw[3], nchw[2], int_value_1});
+    AddAttribute(grid_shape_x, "axis", int64_t(0));
+    AddAttribute(grid_shape_y, "axis", int64_t(0));
+    auto grid_x = helper_->MakeNode(
+        "Reshape", {grid_x_1->output(0), grid_shape_x->output(0)});
+    auto grid_y_2 = helper_->MakeNode(
+        "Reshape", {grid_y_1->output(0), grid_shape_y->output(0)});
+    auto grid_y = helper_->MakeNode("Transpose", {grid_y_2->output(0)});
+    {
+      std::vector<int64_t> perm({1, 0, 2});
+      AddAttribute(grid_y, "perm", perm);
+    }
+
+    auto grid =
+        helper_->MakeNode("Concat", {grid_x->output(0), grid_y->output(0)});
+    AddAttribute(grid, "axis", int64_t(2));
+
+    auto scale_x_y = helper_->Constant({1}, dtype, scale_x_y_);
+    auto bias_x_y = helper_->Constant({1}, dtype, bias_x_y_value);
+    wh = helper_->Concat({float_w, float_h}, 0);
+    pred_box_xy = helper_->MakeNode("Mul", {pred_box_xy, scale_x_y})->output(0);
+    pred_box_xy = helper_->MakeNode("Add", {pred_box_xy, bias_x_y})->output(0);
+    pred_box_xy =
+        helper_->MakeNode("Add", {pred_box_xy, grid->output(0)})->output(0);
+    pred_box_xy = helper_->MakeNode("Div", {pred_box_xy, wh})->output(0);
+  }
 
   // anchors = [(anchors[i], anchors[i + 1]) for i in range(0, len(anchors), 2)]
   // anchors_s = np.array(
   //     [(an_w / input_w, an_h / input_h) for an_w, an_h in anchors])
   // anchor_w = anchors_s[:, 0:1].reshape((1, an_num, 1, 1))
   // anchor_h = anchors_s[:, 1:2].reshape((1, an_num, 1, 1))
-  std::vector<int64_t> valid_anchors(anchor_num);
-  valid_anchors.assign(anchors_.begin(), anchors_.begin() + anchor_num * 2);
-  auto anchors =
-      helper_->Constant(GetOnnxDtype(x_info[0].dtype), valid_anchors);
-  anchors = helper_->Reshape(anchors, {anchor_num, 2});
-
-  auto downsample =
-      helper_->Constant({1}, GetOnnxDtype(x_info[0].dtype), downsample_ratio_);
-  auto ori_wh =
-      helper_->MakeNode("Mul", {wh->output(0), downsample})->output(0);
-  anchors = helper_->MakeNode("Div", {anchors, ori_wh})->output(0);
-  // Following divide operation requires undirectional broadcast
-  // It satisfies the definition of ONNX, but now sure all the inference engines
-  // support this rule e.g TensorRT、OpenVINO anchor_w = anchors_s[:,
-  // 0:1].reshape((1, an_num, 1, 1)) anchor_h = anchors_s[:, 1:2].reshape((1,
-  // an_num, 1, 1)) pred_box[:, :, :, :, 2] = np.exp(pred_box[:, :, :, :, 2]) *
-  // anchor_w pred_box[:, :, :, :, 3] = np.exp(pred_box[:, :, :, :, 3]) *
-  // anchor_h
-  anchors = helper_->Reshape(anchors, {1, anchor_num, 1, 1, 2});
+  std::string anchors;
+  if (is_static) {
+    std::vector<float> anchors_s(anchor_num * 2);
+    for (int64_t i = 0; i < anchor_num; ++i) {
+      anchors_s[i * 2] =
+          static_cast<float>(anchors_[i * 2]) / (w * downsample_ratio_);
+      anchors_s[i * 2 + 1] =
+          static_cast<float>(anchors_[i * 2 + 1]) / (h * downsample_ratio_);
+    }
+    anchors = helper_->Assign(dtype, {1, anchor_num, 1, 1, 2}, anchors_s);
+  } else {
+    std::vector<int64_t> valid_anchors(anchor_num);
+    valid_anchors.assign(anchors_.begin(), anchors_.begin() + anchor_num * 2);
+    anchors = helper_->Constant(dtype, valid_anchors);
+    anchors = helper_->Reshape(anchors, {anchor_num, 2});
+
+    auto downsample = helper_->Constant({1}, dtype, downsample_ratio_);
+    auto ori_wh = helper_->MakeNode("Mul", {wh, downsample})->output(0);
+    anchors = helper_->MakeNode("Div", {anchors, ori_wh})->output(0);
+    // Following divide operation requires undirectional broadcast
+    // It satisfies the definition of ONNX, but now sure all the inference
+    // engines support this rule e.g TensorRT、OpenVINO anchor_w = anchors_s[:,
+    // 0:1].reshape((1, an_num, 1, 1)) anchor_h = anchors_s[:, 1:2].reshape((1,
+    // an_num, 1, 1)) pred_box[:, :, :, :, 2] = np.exp(pred_box[:, :, :, :, 2])
+    // * anchor_w pred_box[:, :, :, :, 3] = np.exp(pred_box[:, :, :, :, 3]) *
+    // anchor_h
+    anchors = helper_->Reshape(anchors, {1, anchor_num, 1, 1, 2});
+  }
   auto pred_box_wh =
       helper_->Slice(transposed_x->output(0), {0, 1, 2, 3, 4}, {0, 0, 0, 0, 2},
                      {max_int, max_int, max_int, max_int, 4});
@@ -178,10 +220,8 @@ void YoloBoxMapper::Opset11() {
     ioup = helper_->Unsqueeze(ioup, {4});
     ioup = helper_->MakeNode("Sigmoid", {ioup})->output(0);
     float power_value_0 = 1 - iou_aware_factor_;
-    auto power_0 =
-        helper_->Constant({1}, GetOnnxDtype(x_info[0].dtype), power_value_0);
-    auto power_1 = helper_->Constant({1}, GetOnnxDtype(x_info[0].dtype),
-                                     iou_aware_factor_);
+    auto power_0 = helper_->Constant({1}, dtype, power_value_0);
+    auto power_1 = helper_->Constant({1}, dtype, iou_aware_factor_);
     ioup = helper_->MakeNode("Pow", {ioup, power_1})->output(0);
     pred_conf = helper_->MakeNode("Pow", {pred_conf, power_0})->output(0);
     pred_conf = helper_->MakeNode("Mul", {pred_conf, ioup})->output(0);
@@ -190,14 +230,12 @@ void YoloBoxMapper::Opset11() {
   // pred_conf[pred_conf < conf_thresh] = 0.
   // pred_score = sigmoid(x[:, :, :, :, 5:]) * pred_conf
   // pred_box = pred_box * (pred_conf > 0.).astype('float32')
-  auto value_2 =
-      helper_->Constant({1}, GetOnnxDtype(x_info[0].dtype), float(2.0));
+  auto value_2 = helper_->Constant({1}, dtype, float(2.0));
   auto center = helper_->MakeNode("Div", {pred_box_wh, value_2})->output(0);
   auto min_xy = helper_->MakeNode("Sub", {pred_box_xy, center})->output(0);
   auto max_xy = helper_->MakeNode("Add", {pred_box_xy, center})->output(0);
 
-  auto conf_thresh =
-      helper_->Constant({1}, GetOnnxDtype(x_info[0].dtype), conf_thresh_);
+  auto conf_thresh = helper_->Constant({1}, dtype, conf_thresh_);
   auto filter =
       helper_->MakeNode("Greater", {pred_conf, conf_thresh})->output(0);
   filter = helper_->AutoCast(filter, P2ODataType::BOOL, x_info[0].dtype);
@@ -210,12 +248,17 @@ void YoloBoxMapper::Opset11() {
   auto pred_box = helper_->Concat({min_xy, max_xy}, 4);
   pred_box = helper_->MakeNode("Mul", {pred_box, filter})->output(0);
 
-  auto value_neg_1 =
-      helper_->Constant({1}, ONNX_NAMESPACE::TensorProto::INT64, int64_t(-1));
-  auto value_4 =
-      helper_->Constant({1}, ONNX_NAMESPACE::TensorProto::INT64, int64_t(4));
-  auto new_shape = helper_->Concat({nchw[0], value_neg_1, value_4}, 0);
-  pred_box = helper_->MakeNode("Reshape", {pred_box, new_shape})->output(0);
+  std::string value_neg_1;
+  if (is_static) {
+    pred_box = helper_->Reshape(pred_box, {0, -1, 4});
+  } else {
+    value_neg_1 =
+        helper_->Constant({1}, ONNX_NAMESPACE::TensorProto::INT64, int64_t(-1));
+    auto value_4 =
+        helper_->Constant({1}, ONNX_NAMESPACE::TensorProto::INT64, int64_t(4));
+    auto new_shape = helper_->Concat({nchw[0], value_neg_1, value_4}, 0);
+    pred_box = helper_->MakeNode("Reshape", {pred_box, new_shape})->output(0);
+  }
 
   auto float_img_size = helper_->AutoCast(
       im_size_info[0].name, im_size_info[0].dtype, x_info[0].dtype);
@@ -242,12 +285,17 @@ void YoloBoxMapper::Opset11() {
                       boxes_info[0].dtype);
   }
 
-  auto class_num =
-      helper_->Constant({1}, ONNX_NAMESPACE::TensorProto::INT64, class_num_);
-  auto score_out_shape =
-      helper_->Concat({nchw[0], value_neg_1, class_num}, int64_t(0));
-  auto score_out =
-      helper_->MakeNode("Reshape", {pred_score, score_out_shape})->output(0);
+  std::string score_out;
+  if (is_static) {
+    score_out = helper_->Reshape(pred_score, {0, -1, class_num_});
+  } else {
+    auto class_num =
+        helper_->Constant({1}, ONNX_NAMESPACE::TensorProto::INT64, class_num_);
+    auto score_out_shape =
+        helper_->Concat({nchw[0], value_neg_1, class_num}, int64_t(0));
+    score_out =
+        helper_->MakeNode("Reshape", {pred_score, score_out_shape})->output(0);
+  }
   helper_->AutoCast(score_out, scores_info[0].name, x_info[0].dtype,
                     scores_info[0].dtype);
 }
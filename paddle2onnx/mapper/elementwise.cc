@@ -45,6 +45,16 @@ void ElementwiseMapper::Opset7() {
     helper_->MakeNode(iter->second,
                       {input_x_info[0].name, input_y_info[0].name},
                       {output_info[0].name});
+  } else if (IsExclusiveParameterInput("Y") &&
+             GetParameter("Y")->shape.size() + axis_ <=
+                 input_x_info[0].Rank()) {
+    // Reshape the parameter only read by this operator while exporting, only
+    // the trailing dimensions are needed for broadcasting
+    Weight weight = *GetParameter("Y");
+    weight.shape.resize(input_x_info[0].Rank() - axis_, 1);
+    std::string y_node = helper_->Constant(weight);
+    helper_->MakeNode(iter->second, {input_x_info[0].name, y_node},
+                      {output_info[0].name});
   } else {
     std::vector<int64_t> broadcast_shape(input_x_info[0].Rank(), 1);
     for (int i = axis_; i < axis_ + input_y_info[0].Rank(); ++i) {
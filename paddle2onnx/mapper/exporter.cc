@@ -15,13 +15,19 @@
 #include "paddle2onnx/mapper/exporter.h"
 
 #include <onnx/checker.h>
+#include <onnx/shape_inference/implementation.h>
 
 #include "onnxoptimizer/optimize.h"
+#include "paddle2onnx/optimizer/eliminate_layout_transpose.h"
 #include "paddle2onnx/optimizer/eliminate_non_transpose.h"
+#include "paddle2onnx/optimizer/fold_constant.h"
 #include "paddle2onnx/optimizer/fuse_constant_cast.h"
 #include "paddle2onnx/optimizer/fuse_constant_reshape.h"
 #include "paddle2onnx/optimizer/fuse_constant_unsqueeze.h"
+#include "paddle2onnx/optimizer/fuse_paddle_attention.h"
+#include "paddle2onnx/optimizer/fuse_paddle_affine.h"
 #include "paddle2onnx/optimizer/fuse_paddle_conv_bias.h"
+#include "paddle2onnx/optimizer/fuse_paddle_conv_bn.h"
 #include "paddle2onnx/optimizer/fuse_unsqueeze_conv2d_squeeze.h"
 
 namespace paddle2onnx {
@@ -54,17 +60,16 @@ void ModelExporter::ExportOp(const PaddleParser& parser, OnnxHelper* helper,
                              int32_t opset_version, int64_t block_id,
                              int64_t op_id, bool verbose) {
   _current_exported_num += 1;
-  auto op = parser.GetOpDesc(block_id, op_id);
+  auto& op = parser.GetOpDesc(block_id, op_id);
 #ifdef PADDLE2ONNX_DEBUG
   P2OLogger(true) << "Converting operator: " << op.type() << std::endl;
 #endif
   if (op.type() == "while") {
     return ExportLoop(parser, helper, opset_version, block_id, op_id, verbose);
   }
-  auto mapper = MapperHelper::Get()->CreateMapper(op.type(), parser, helper,
-                                                  block_id, op_id);
+  auto mapper = MapperHelper::Get()->AcquireMapper(op.type(), parser, helper,
+                                                   block_id, op_id);
   mapper->Run();
-  delete mapper;
 #ifdef PADDLE2ONNX_DEBUG
   P2OLogger(true) << "Operator: " << op.type() << " done." << std::endl;
 #endif
@@ -180,12 +185,35 @@ void ModelExporter::ProcessGraphDumplicateNames(
   }
 }
 
-std::string ModelExporter::Run(const PaddleParser& parser, int opset_version,
-                               bool auto_upgrade_opset, bool verbose,
-                               bool enable_onnx_checker,
-                               bool enable_experimental_op,
-                               bool enable_optimize) {
+std::string ModelExporter::Run(const PaddleParser& parser,
+                               const ExportOptions& options) {
+  int32_t opset_version = options.opset_version;
   _helper.SetOpsetVersion(opset_version);
+  Assert(options.target_profile == "standard" ||
+             options.target_profile == "onnxruntime-cpu",
+         "Paddle2ONNX now only support target_profile in [standard, "
+         "onnxruntime-cpu], but now it's " + options.target_profile + ".");
+  _helper.SetTargetProfile(options.target_profile);
+  Assert(options.weight_quantize_type == "none" ||
+             options.weight_quantize_type == "int8" ||
+             options.weight_quantize_type == "int4",
+         "Paddle2ONNX now only support weight_quantize_type in [none, int8, "
+         "int4], but now it's " + options.weight_quantize_type + ".");
+  Assert(CheckDimParams(parser, options.dim_params),
+         "The specified dim_params are invalid.");
+  _dim_params = options.dim_params;
+  _loop_unroll_threshold = options.loop_unroll_threshold;
+  _fp16_keep_io_types = options.fp16_keep_io_types;
+  _fp32_tensors.clear();
+  std::set<std::string> keep_ops(options.fp16_keep_ops.begin(),
+                                 options.fp16_keep_ops.end());
+  if (parser.NumOfDeadOps() > 0) {
+    P2OLogger(options.verbose)
+        << parser.NumOfDeadOps()
+        << " operators are not related to the fetch targets, they will not "
+           "be exported."
+        << std::endl;
+  }
   _total_ops_num = 0;
   _current_exported_num = 0;
   for (auto i = 0; i < parser.NumOfBlocks(); ++i) {
@@ -207,7 +235,8 @@ std::string ModelExporter::Run(const PaddleParser& parser, int opset_version,
   MapperHelper::Get()->ClearNameCounter();
 
   std::set<std::string> unsupported_ops;
-  if (!CheckIfOpSupported(parser, &unsupported_ops, enable_experimental_op)) {
+  if (!CheckIfOpSupported(parser, &unsupported_ops,
+                          options.enable_experimental_op)) {
     auto logger = P2OLogger();
     logger << "Oops, there are some operators not supported yet, including ";
     for (auto& item : unsupported_ops) {
@@ -218,13 +247,13 @@ std::string ModelExporter::Run(const PaddleParser& parser, int opset_version,
            "Due to the unsupported operators, the conversion is aborted.");
   }
 
-  int32_t min_opset = GetMinOpset(parser, verbose);
+  int32_t min_opset = GetMinOpset(parser, options.verbose);
   if (min_opset < 0) {
     Assert(false,
            "Model exporting failed, you can report this problem to "
            "https://github.com/PaddlePaddle/Paddle2ONNX.git.");
   }
-  if (!auto_upgrade_opset) {
+  if (!options.auto_upgrade_opset) {
     if (min_opset > opset_version) {
       P2OLogger() << "This PaddlePaddle model is not able to export to ONNX "
                      "with opset_version="
@@ -251,13 +280,24 @@ std::string ModelExporter::Run(const PaddleParser& parser, int opset_version,
   // Only convert blocks 0 now
   // because control flow is not supported yet
   for (auto i = 0; i < parser.NumOfOps(0); ++i) {
-    auto op = parser.GetOpDesc(0, i);
+    auto& op = parser.GetOpDesc(0, i);
     if (op.type() == "feed") {
       continue;
     } else if (op.type() == "fetch") {
       continue;
     }
-    ExportOp(parser, &_helper, opset_version, 0, i, verbose);
+    size_t num_nodes = _helper.nodes.size();
+    ExportOp(parser, &_helper, opset_version, 0, i, options.verbose);
+    if (options.export_fp16_model &&
+        keep_ops.find(op.type()) != keep_ops.end()) {
+      for (auto j = num_nodes; j < _helper.nodes.size(); ++j) {
+        for (auto& output : _helper.nodes[j]->output()) {
+          if (!output.empty()) {
+            _fp32_tensors.insert(output);
+          }
+        }
+      }
+    }
   }
   // construct a onnx model proto
   auto model = std::make_shared<ONNX_NAMESPACE::ModelProto>();
@@ -269,6 +309,11 @@ std::string ModelExporter::Run(const PaddleParser& parser, int opset_version,
   // TODO(jiangjiajun) custom op is not considered
   opset_id->set_domain("");
   opset_id->set_version(opset_version);
+  if (_helper.IsOnnxRuntimeTarget()) {
+    auto contrib_opset_id = model->add_opset_import();
+    contrib_opset_id->set_domain("com.microsoft");
+    contrib_opset_id->set_version(1);
+  }
 
   ProcessGraphDumplicateNames(&parameters, &inputs, &outputs, &_helper.nodes);
   // RemoveIsolatedNodes(&parameters, &inputs, &outputs, &_helper.nodes);
@@ -294,11 +339,12 @@ std::string ModelExporter::Run(const PaddleParser& parser, int opset_version,
   // this check will return a information
   // to let framework know the conversion is
   // pass or fail
-  if (enable_onnx_checker) {
+  if (options.enable_onnx_checker) {
     try {
       ONNX_NAMESPACE::checker::check_model(*(model.get()));
     } catch (...) {
-      P2OLogger(verbose) << "The exported ONNX model is invalid." << std::endl;
+      P2OLogger(options.verbose) << "The exported ONNX model is invalid."
+                                 << std::endl;
       return "";
     }
     P2OLogger()
@@ -307,17 +353,35 @@ std::string ModelExporter::Run(const PaddleParser& parser, int opset_version,
   }
 
   std::string out;
-  if (enable_optimize) {
-    auto const opt_model = Optimize(*(model.get()));
+  if (options.enable_optimize) {
+    auto opt_model = Optimize(*(model.get()), options.enable_fused_attention);
+    if (options.weight_quantize_type != "none") {
+      QuantizeWeights(&opt_model, options.weight_quantize_type,
+                      options.weight_quantize_threshold,
+                      options.weight_quantize_pattern, options.verbose);
+    }
+    if (options.export_fp16_model) {
+      ConvertToFloat16(parser, &opt_model);
+    }
+    InferValueInfo(parser, &opt_model, options.verbose);
     if (!opt_model.SerializeToString(&out)) {
-      P2OLogger(verbose)
+      P2OLogger(options.verbose)
           << "Error happenedd while optimizing the exported ONNX model."
           << std::endl;
       return "";
     }
   } else {
+    if (options.weight_quantize_type != "none") {
+      QuantizeWeights(model.get(), options.weight_quantize_type,
+                      options.weight_quantize_threshold,
+                      options.weight_quantize_pattern, options.verbose);
+    }
+    if (options.export_fp16_model) {
+      ConvertToFloat16(parser, model.get());
+    }
+    InferValueInfo(parser, model.get(), options.verbose);
     if (!model->SerializeToString(&out)) {
-      P2OLogger(verbose)
+      P2OLogger(options.verbose)
           << "Error happened while optimizing the exported ONNX model."
           << std::endl;
       return "";
@@ -332,7 +396,7 @@ bool ModelExporter::CheckIfOpSupported(const PaddleParser& parser,
   unsupported_ops->clear();
   for (auto i = 0; i < parser.NumOfBlocks(); ++i) {
     for (auto j = 0; j < parser.NumOfOps(i); ++j) {
-      auto op = parser.GetOpDesc(i, j);
+      auto& op = parser.GetOpDesc(i, j);
       if (op.type() == "feed" || op.type() == "fetch") {
         continue;
       }
@@ -342,15 +406,15 @@ bool ModelExporter::CheckIfOpSupported(const PaddleParser& parser,
         }
         continue;
       }
-      if (!MapperHelper::Get()->IsRegistered(op.type())) {
+      auto mapper_id = MapperHelper::Get()->GetOpId(op.type());
+      if (mapper_id < 0) {
         unsupported_ops->insert(op.type());
       } else if (!enable_experimental_op) {
-        auto mapper = MapperHelper::Get()->CreateMapper(op.type(), parser,
-                                                        &_helper, i, j);
+        auto mapper = MapperHelper::Get()->AcquireMapper(mapper_id, parser,
+                                                         &_helper, i, j);
         if (mapper->IsExperimentalOp()) {
           unsupported_ops->insert(op.type());
         }
-        delete mapper;
       }
     }
   }
@@ -366,7 +430,7 @@ int32_t ModelExporter::GetMinOpset(const PaddleParser& parser, bool verbose) {
   std::set<std::string> verbose_log;
   for (auto i = 0; i < parser.NumOfBlocks(); ++i) {
     for (auto j = 0; j < parser.NumOfOps(i); ++j) {
-      auto op = parser.GetOpDesc(i, j);
+      auto& op = parser.GetOpDesc(i, j);
       if (op.type() == "feed" || op.type() == "fetch") {
         continue;
       }
@@ -378,10 +442,9 @@ int32_t ModelExporter::GetMinOpset(const PaddleParser& parser, bool verbose) {
                     << std::endl;
         current_min_opset = 13;
       } else {
-        auto mapper = MapperHelper::Get()->CreateMapper(op.type(), parser,
-                                                        &_helper, i, j);
+        auto mapper = MapperHelper::Get()->AcquireMapper(op.type(), parser,
+                                                         &_helper, i, j);
         current_min_opset = mapper->GetMinOpset(verbose);
-        delete mapper;
       }
       if (current_min_opset < 0) {
         exportable = false;
@@ -426,33 +489,233 @@ int32_t ModelExporter::GetMinOpset(const PaddleParser& parser, bool verbose) {
   return -1;
 }
 
+bool ModelExporter::CheckDimParams(
+    const PaddleParser& parser,
+    const std::map<std::string, std::vector<std::string>>& dim_params) {
+  for (auto& item : dim_params) {
+    const TensorInfo* info = nullptr;
+    for (auto& tensor : parser.inputs) {
+      if (tensor.name == item.first) {
+        info = &tensor;
+      }
+    }
+    for (auto& tensor : parser.outputs) {
+      if (tensor.name == item.first) {
+        info = &tensor;
+      }
+    }
+    if (info == nullptr) {
+      P2OLogger() << "[ERROR] Cannot find input or output: " << item.first
+                  << " in the model." << std::endl;
+      return false;
+    }
+    if (info->shape.size() != item.second.size()) {
+      P2OLogger() << "[ERROR] The rank of " << item.first << " is "
+                  << info->shape.size() << ", but the specified dim_params has "
+                  << item.second.size() << " dimensions." << std::endl;
+      return false;
+    }
+    for (size_t i = 0; i < item.second.size(); ++i) {
+      if (!item.second[i].empty() && info->shape[i] >= 0) {
+        P2OLogger() << "[ERROR] The dimension " << i << " of " << item.first
+                    << " is " << info->shape[i]
+                    << ", only the dynamic dimension can be named."
+                    << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Name the unknown dimensions as dim_param, so that the runtimes are able to
+// plan the memory with symbolic shapes. The names in `dim_params` are used
+// first, and the others are named as unk__N
+static void NameUnknownDims(ONNX_NAMESPACE::ValueInfoProto* value_info,
+                            const std::vector<std::string>& dim_params,
+                            int64_t* counter) {
+  if (!value_info->type().has_tensor_type() ||
+      !value_info->type().tensor_type().has_shape()) {
+    return;
+  }
+  auto shape =
+      value_info->mutable_type()->mutable_tensor_type()->mutable_shape();
+  for (auto i = 0; i < shape->dim_size(); ++i) {
+    auto dim = shape->mutable_dim(i);
+    if (dim->has_dim_value()) {
+      continue;
+    }
+    if (i < static_cast<int>(dim_params.size()) && !dim_params[i].empty()) {
+      dim->set_dim_param(dim_params[i]);
+    } else if (!dim->has_dim_param()) {
+      dim->set_dim_param("unk__" + std::to_string((*counter)++));
+    }
+  }
+}
+
+// Shape inference names the symbols it generates as unk__N too, so the counter
+// has to skip all the existing ones
+static void SkipUnknownDimNames(
+    const ONNX_NAMESPACE::ValueInfoProto& value_info, int64_t* counter) {
+  if (!value_info.type().has_tensor_type() ||
+      !value_info.type().tensor_type().has_shape()) {
+    return;
+  }
+  for (auto& dim : value_info.type().tensor_type().shape().dim()) {
+    const std::string& name = dim.dim_param();
+    if (name.size() <= 5 || name.size() > 20 || name.compare(0, 5, "unk__")) {
+      continue;
+    }
+    if (name.find_first_not_of("0123456789", 5) != std::string::npos) {
+      continue;
+    }
+    int64_t index = std::stoll(name.substr(5));
+    *counter = std::max(*counter, index + 1);
+  }
+}
+
+void ModelExporter::InferValueInfo(const PaddleParser& parser,
+                                   ONNX_NAMESPACE::ModelProto* model,
+                                   bool verbose) {
+  auto graph = model->mutable_graph();
+  int64_t counter = 0;
+  auto get_dim_params = [this](const std::string& name) {
+    auto iter = _dim_params.find(name);
+    if (iter == _dim_params.end()) {
+      return std::vector<std::string>();
+    }
+    return iter->second;
+  };
+  // The symbols of inputs will be propagated by shape inference, so the
+  // dimensions with the same name are known as equal through the whole graph
+  for (auto i = 0; i < graph->input_size(); ++i) {
+    auto input = graph->mutable_input(i);
+    NameUnknownDims(input, get_dim_params(input->name()), &counter);
+  }
+  try {
+    ONNX_NAMESPACE::shape_inference::InferShapes(*model);
+  } catch (const std::exception& e) {
+    P2OLogger(verbose) << "[WARN] Failed to infer shapes of the exported "
+                          "model: "
+                       << e.what() << std::endl;
+  }
+
+  for (auto value_infos :
+       {&graph->input(), &graph->value_info(), &graph->output()}) {
+    for (auto& value_info : *value_infos) {
+      SkipUnknownDimNames(value_info, &counter);
+    }
+  }
+
+  // The static dimensions recorded in PaddlePaddle program are used while
+  // shape inference is not able to get them, except the models with
+  // multiclass_nms, whose shapes recorded in program are not reliable
+  if (!parser.HasNms()) {
+    for (auto i = 0; i < graph->value_info_size(); ++i) {
+      auto value_info = graph->mutable_value_info(i);
+      auto iter = parser._blocks_var_name2id[0].find(value_info->name());
+      if (iter == parser._blocks_var_name2id[0].end() ||
+          !value_info->type().has_tensor_type() ||
+          !value_info->type().tensor_type().has_shape()) {
+        continue;
+      }
+      auto& var_type = parser.prog->blocks(0).vars(iter->second).type();
+      if (!var_type.has_lod_tensor()) {
+        continue;
+      }
+      auto& tensor = var_type.lod_tensor().tensor();
+      auto tensor_type = value_info->mutable_type()->mutable_tensor_type();
+      int32_t dtype = tensor.data_type();
+      // Only the data types supported by GetOnnxDtype are compared
+      if ((dtype > P2ODataType::FP64 && dtype != P2ODataType::UINT8 &&
+           dtype != P2ODataType::INT8) ||
+          tensor_type->elem_type() != GetOnnxDtype(dtype) ||
+          tensor_type->shape().dim_size() != tensor.dims_size()) {
+        continue;
+      }
+      for (auto j = 0; j < tensor.dims_size(); ++j) {
+        auto dim = tensor_type->mutable_shape()->mutable_dim(j);
+        if (!dim->has_dim_value() && !dim->has_dim_param() &&
+            tensor.dims(j) >= 0) {
+          dim->set_dim_value(tensor.dims(j));
+        }
+      }
+    }
+  }
+
+  for (auto i = 0; i < graph->value_info_size(); ++i) {
+    NameUnknownDims(graph->mutable_value_info(i), {}, &counter);
+  }
+  // The names specified for outputs take precedence over the propagated
+  // symbols, which are lost while shape inference is not able to trace them
+  for (auto i = 0; i < graph->output_size(); ++i) {
+    auto output = graph->mutable_output(i);
+    NameUnknownDims(output, get_dim_params(output->name()), &counter);
+  }
+}
+
 ONNX_NAMESPACE::ModelProto ModelExporter::Optimize(
-    const ONNX_NAMESPACE::ModelProto& model) {
+    const ONNX_NAMESPACE::ModelProto& model, bool enable_fused_attention) {
+  ONNX_NAMESPACE::optimization::Optimizer::passes
+      .registerPass<ONNX_NAMESPACE::optimization::FoldConstant>();
   ONNX_NAMESPACE::optimization::Optimizer::passes
       .registerPass<ONNX_NAMESPACE::optimization::FuseConstantReshape>();
   ONNX_NAMESPACE::optimization::Optimizer::passes
       .registerPass<ONNX_NAMESPACE::optimization::FuseConstantUnsqueeze>();
   ONNX_NAMESPACE::optimization::Optimizer::passes
       .registerPass<ONNX_NAMESPACE::optimization::FusePaddleConvBias>();
+  ONNX_NAMESPACE::optimization::Optimizer::passes
+      .registerPass<ONNX_NAMESPACE::optimization::FusePaddleConvBN>();
+  ONNX_NAMESPACE::optimization::Optimizer::passes
+      .registerPass<ONNX_NAMESPACE::optimization::FusePaddleAffine>();
+  ONNX_NAMESPACE::optimization::Optimizer::passes
+      .registerPass<ONNX_NAMESPACE::optimization::FusePaddleAttention>();
   ONNX_NAMESPACE::optimization::Optimizer::passes
       .registerPass<ONNX_NAMESPACE::optimization::FuseUnsqueezeConv2dSqueeze>();
   ONNX_NAMESPACE::optimization::Optimizer::passes
       .registerPass<ONNX_NAMESPACE::optimization::EliminateNonTranspose>();
+  ONNX_NAMESPACE::optimization::Optimizer::passes
+      .registerPass<ONNX_NAMESPACE::optimization::EliminateLayoutTranspose>();
   ONNX_NAMESPACE::optimization::Optimizer::passes
       .registerPass<ONNX_NAMESPACE::optimization::FuseConstantCast>();
   std::vector<std::string> passes = {"eliminate_identity",
                                      "eliminate_deadend",
                                      "eliminate_deadend",
+                                     "fold_constant",
                                      "fuse_constant_reshape",
                                      "fuse_constant_unsqueeze",
+                                     "eliminate_layout_transpose",
                                      "fuse_paddle_conv_bias",
+                                     "fuse_paddle_conv_bn",
+                                     "fuse_paddle_affine",
                                      "fuse_consecutive_transposes",
                                      "eliminate_non_transpose",
                                      "fuse_matmul_add_bias_into_gemm",
                                      "eliminate_identity",
                                      "eliminate_deadend",
                                      "eliminate_unused_initializer"};
-  return ONNX_NAMESPACE::optimization::Optimize(model, passes);
+  if (enable_fused_attention) {
+    // The transposes of K should be merged before fusing attention
+    auto iter =
+        std::find(passes.begin(), passes.end(), "eliminate_non_transpose");
+    passes.insert(iter + 1, "fuse_paddle_attention");
+  }
+  auto optimized_model = ONNX_NAMESPACE::optimization::Optimize(model, passes);
+  // The fused attention operator comes from onnxruntime contrib operators
+  for (auto& opset_id : optimized_model.opset_import()) {
+    if (opset_id.domain() == "com.microsoft") {
+      return optimized_model;
+    }
+  }
+  for (auto& node : optimized_model.graph().node()) {
+    if (node.domain() == "com.microsoft") {
+      auto opset_id = optimized_model.add_opset_import();
+      opset_id->set_domain("com.microsoft");
+      opset_id->set_version(1);
+      break;
+    }
+  }
+  return optimized_model;
 }
 
 }  // namespace paddle2onnx
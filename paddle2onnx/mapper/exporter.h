@@ -18,11 +18,24 @@
 #include <algorithm>
 #include <set>
 
+#include "paddle2onnx/converter.h"
 #include "paddle2onnx/mapper/mapper.h"
 #include "paddle2onnx/parser/parser.h"
 
 namespace paddle2onnx {
 
+// The counter of while operator in pattern
+//   while (less_than(i, n)) { ...; i = increment(i, step); }
+// `inclusive` is true if the condition is less_equal
+struct LoopCounter {
+  std::string counter;
+  std::string limit;
+  int64_t step = 1;
+  bool inclusive = false;
+  int32_t counter_dtype = P2ODataType::INT64;
+  int32_t limit_dtype = P2ODataType::INT64;
+};
+
 struct ModelExporter {
  private:
   std::vector<std::shared_ptr<ONNX_NAMESPACE::NodeProto>> parameters;
@@ -31,6 +44,17 @@ struct ModelExporter {
   OnnxHelper _helper;
   int32_t _total_ops_num = 0;
   int32_t _current_exported_num = 0;
+  // The while operators with static trip count no more than this threshold
+  // will be unrolled, 0 means disabled
+  int32_t _loop_unroll_threshold = 0;
+  // Keep the data types of inputs and outputs while exporting float16 model
+  bool _fp16_keep_io_types = true;
+  // The output tensors of the nodes exported from the operators in keep-list
+  // of float16 model, the nodes are not always named
+  std::set<std::string> _fp32_tensors;
+  // The user specified dim_param of the dynamic dimensions of inputs and
+  // outputs, empty string means the dimension is named automatically
+  std::map<std::string, std::vector<std::string>> _dim_params;
 
   void ExportParameters(const std::map<std::string, Weight>& params,
                         bool use_initializer = false);
@@ -44,8 +68,40 @@ struct ModelExporter {
   void ExportLoop(const PaddleParser& parser, OnnxHelper* helper,
                   int32_t opset_version, int64_t block_id, int64_t op_id,
                   bool verbose);
+  bool GetLoopCounter(const PaddleParser& parser, int64_t sub_block_id,
+                      const std::string& cond_name, LoopCounter* counter);
+  // Compute the trip count of while operator, return empty string if the
+  // counter pattern is not matched
+  std::string LoopTripCount(const PaddleParser& parser, OnnxHelper* helper,
+                            int64_t sub_block_id, const std::string& cond_name);
+  // Get the trip count of while operator while the counter, limit and the
+  // initial condition are all constants, return -1 if it's not static
+  int64_t StaticLoopTripCount(const PaddleParser& parser, int64_t block_id,
+                              int64_t op_id, int64_t sub_block_id,
+                              const std::string& cond_name);
 
-  ONNX_NAMESPACE::ModelProto Optimize(const ONNX_NAMESPACE::ModelProto& model);
+  ONNX_NAMESPACE::ModelProto Optimize(const ONNX_NAMESPACE::ModelProto& model,
+                                      bool enable_fused_attention = false);
+  // Convert the weights and computation to float16, the nodes producing
+  // _fp32_tensors and the operators without float16 support stay in float32
+  void ConvertToFloat16(const PaddleParser& parser,
+                        ONNX_NAMESPACE::ModelProto* model);
+  // Quantize the float32 weights with at least `threshold` elements and the
+  // names matched by `pattern` to int8(DequantizeLinear) or int4(MatMulNBits
+  // of onnxruntime)
+  void QuantizeWeights(ONNX_NAMESPACE::ModelProto* model,
+                       const std::string& quantize_type, int64_t threshold,
+                       const std::string& pattern, bool verbose = false);
+  // Fill the value_info of intermediate tensors by ONNX shape inference and
+  // the variable shapes of PaddlePaddle, the unknown dimensions are named as
+  // dim_param
+  void InferValueInfo(const PaddleParser& parser,
+                      ONNX_NAMESPACE::ModelProto* model, bool verbose = false);
+  // Check the names and ranks of tensors in dim_params, only the dynamic
+  // dimensions of inputs and outputs are able to be named
+  bool CheckDimParams(
+      const PaddleParser& parser,
+      const std::map<std::string, std::vector<std::string>>& dim_params);
 
  public:
   // Get a proper opset version in range of [7, 15]
@@ -72,11 +128,9 @@ struct ModelExporter {
                           std::set<std::string>* unsupported_ops,
                           bool enable_experimental_op);
 
-  std::string Run(const PaddleParser& parser, int opset_version = 9,
-                  bool auto_upgrade_opset = true, bool verbose = false,
-                  bool enable_onnx_checker = true,
-                  bool enable_experimental_op = false,
-                  bool enable_optimize = true);
+  // The input_shapes of options are not used here, they should be applied to
+  // the parser by SetInputShapes before
+  std::string Run(const PaddleParser& parser, const ExportOptions& options);
 };
 
 }  // namespace paddle2onnx
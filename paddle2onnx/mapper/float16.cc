@@ -0,0 +1,333 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <onnx/shape_inference/implementation.h>
+
+#include <cstring>
+
+#include "paddle2onnx/mapper/exporter.h"
+
+namespace paddle2onnx {
+
+// Convert float to IEEE half precision with round to nearest even, the finite
+// values out of range are saturated to the max finite half value
+static uint16_t FloatToHalf(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  uint16_t sign = (bits >> 16) & 0x8000;
+  int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xff) - 127 + 15;
+  uint32_t mantissa = bits & 0x7fffff;
+  if (((bits >> 23) & 0xff) == 0xff) {
+    return sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0);
+  }
+  if (exponent >= 0x1f) {
+    return sign | 0x7bff;
+  }
+  uint32_t half = 0;
+  uint32_t rest = 0;
+  uint32_t halfway = 0;
+  if (exponent <= 0) {
+    if (exponent < -10) {
+      return sign;
+    }
+    // Subnormal half value
+    mantissa |= 0x800000;
+    uint32_t shift = 14 - exponent;
+    half = mantissa >> shift;
+    rest = mantissa & ((1u << shift) - 1);
+    halfway = 1u << (shift - 1);
+  } else {
+    half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    rest = mantissa & 0x1fff;
+    halfway = 0x1000;
+  }
+  if (rest > halfway || (rest == halfway && (half & 1))) {
+    ++half;
+  }
+  return sign | static_cast<uint16_t>(std::min(half, uint32_t(0x7bff)));
+}
+
+// Convert the float tensor to float16 in place
+static void ConvertTensorToHalf(ONNX_NAMESPACE::TensorProto* tensor) {
+  if (tensor->data_type() != ONNX_NAMESPACE::TensorProto::FLOAT) {
+    return;
+  }
+  std::vector<float> data;
+  if (tensor->has_raw_data()) {
+    data.resize(tensor->raw_data().size() / sizeof(float));
+    std::memcpy(data.data(), tensor->raw_data().data(),
+                data.size() * sizeof(float));
+  } else {
+    data.assign(tensor->float_data().begin(), tensor->float_data().end());
+  }
+  std::string raw(data.size() * sizeof(uint16_t), '\0');
+  for (size_t i = 0; i < data.size(); ++i) {
+    uint16_t half = FloatToHalf(data[i]);
+    std::memcpy(&raw[i * sizeof(uint16_t)], &half, sizeof(uint16_t));
+  }
+  tensor->clear_float_data();
+  tensor->set_data_type(ONNX_NAMESPACE::TensorProto::FLOAT16);
+  tensor->set_raw_data(raw);
+}
+
+// The operators do not support float16, or should stay in float32 for
+// the numerical stability
+static bool IsFloat32Node(const ONNX_NAMESPACE::NodeProto& node) {
+  static const std::set<std::string> float32_ops = {
+      "DequantizeLinear", "DynamicQuantizeLinear", "Multinomial",
+      "NonMaxSuppression", "QuantizeLinear", "RandomNormal",
+      "RandomNormalLike", "RandomUniform", "RandomUniformLike", "Range"};
+  if (node.domain() != "" && node.domain() != "ai.onnx") {
+    return true;
+  }
+  if (float32_ops.find(node.op_type()) != float32_ops.end()) {
+    return true;
+  }
+  for (auto& attr : node.attribute()) {
+    if (attr.type() == ONNX_NAMESPACE::AttributeProto::GRAPH ||
+        attr.type() == ONNX_NAMESPACE::AttributeProto::GRAPHS) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// The inputs are always float32 whatever the data type of operator is
+static bool IsFloat32Input(const ONNX_NAMESPACE::NodeProto& node,
+                           int32_t index) {
+  if (node.op_type() == "Upsample" ||
+      (node.op_type() == "Resize" && node.input_size() == 2)) {
+    return index == 1;
+  }
+  if (node.op_type() == "Resize") {
+    return index == 2;
+  }
+  return false;
+}
+
+void ModelExporter::ConvertToFloat16(const PaddleParser& parser,
+                                     ONNX_NAMESPACE::ModelProto* model) {
+  auto graph = model->mutable_graph();
+  const int32_t float32 = ONNX_NAMESPACE::TensorProto::FLOAT;
+  const int32_t float16 = ONNX_NAMESPACE::TensorProto::FLOAT16;
+
+  // Get the data types of all the tensors
+  try {
+    ONNX_NAMESPACE::shape_inference::InferShapes(*model);
+  } catch (const std::exception& e) {
+    P2OLogger() << "[WARN] Failed to infer data types while converting to "
+                   "float16: "
+                << e.what() << std::endl;
+  }
+  std::map<std::string, int32_t> types;
+  auto add_type = [&types](const ONNX_NAMESPACE::ValueInfoProto& info) {
+    if (info.type().has_tensor_type()) {
+      types[info.name()] = info.type().tensor_type().elem_type();
+    }
+  };
+  for (auto& info : graph->input()) {
+    add_type(info);
+  }
+  for (auto& info : graph->value_info()) {
+    add_type(info);
+  }
+  for (auto& info : graph->output()) {
+    add_type(info);
+  }
+  for (auto& tensor : graph->initializer()) {
+    types[tensor.name()] = tensor.data_type();
+  }
+  for (auto& node : graph->node()) {
+    if (node.op_type() == "Constant" && node.attribute_size() == 1 &&
+        node.attribute(0).has_t()) {
+      types[node.output(0)] = node.attribute(0).t().data_type();
+    }
+  }
+  // The outputs of operators without schema are not inferred
+  for (auto& item : parser._blocks_var_name2id[0]) {
+    auto& var_type = parser.prog->blocks(0).vars(item.second).type();
+    if (types.find(item.first) == types.end() && var_type.has_lod_tensor() &&
+        var_type.lod_tensor().tensor().data_type() ==
+            framework::proto::VarType::FP32) {
+      types[item.first] = float32;
+    }
+  }
+  auto is_float = [&types, float32](const std::string& name) {
+    auto iter = types.find(name);
+    return iter != types.end() && iter->second == float32;
+  };
+
+  std::set<std::string> subgraph_inputs;
+  for (auto& node : graph->node()) {
+    CollectSubgraphInputs(node, &subgraph_inputs);
+  }
+  // Decide the operators to be computed in float16
+  std::vector<bool> is_half_node(graph->node_size(), false);
+  std::map<std::string, std::vector<std::pair<int, int>>> consumers;
+  for (auto i = 0; i < graph->node_size(); ++i) {
+    auto& node = graph->node(i);
+    bool keep = IsFloat32Node(node);
+    for (auto& output : node.output()) {
+      keep = keep || subgraph_inputs.find(output) != subgraph_inputs.end() ||
+             _fp32_tensors.find(output) != _fp32_tensors.end();
+    }
+    is_half_node[i] = !keep && node.op_type() != "Constant";
+    for (auto j = 0; j < node.input_size(); ++j) {
+      consumers[node.input(j)].push_back(std::make_pair(i, j));
+    }
+  }
+  // Whether the input of operator expects a float16 tensor, Cast accepts
+  // tensors in any data type
+  auto expects_half = [&](int node_index, int input_index) {
+    auto& node = graph->node(node_index);
+    return is_half_node[node_index] && node.op_type() != "Cast" &&
+           !IsFloat32Input(node, input_index);
+  };
+  // The constants are converted if they're used by any float16 operator
+  auto used_as_half = [&](const std::string& name) {
+    if (subgraph_inputs.find(name) != subgraph_inputs.end()) {
+      return false;
+    }
+    for (auto& consumer : consumers[name]) {
+      if (expects_half(consumer.first, consumer.second)) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  // The float tensors stored as float16 after converting
+  std::set<std::string> half_tensors;
+  for (auto i = 0; i < graph->node_size(); ++i) {
+    auto& node = graph->node(i);
+    if (node.op_type() == "Constant") {
+      is_half_node[i] =
+          is_float(node.output(0)) && used_as_half(node.output(0));
+    }
+    if (!is_half_node[i]) {
+      continue;
+    }
+    for (auto& output : node.output()) {
+      if (is_float(output)) {
+        half_tensors.insert(output);
+      }
+    }
+  }
+  for (auto i = 0; i < graph->initializer_size(); ++i) {
+    auto tensor = graph->mutable_initializer(i);
+    if (is_float(tensor->name()) && used_as_half(tensor->name())) {
+      ConvertTensorToHalf(tensor);
+      half_tensors.insert(tensor->name());
+    }
+  }
+  for (auto i = 0; i < graph->input_size(); ++i) {
+    auto input = graph->mutable_input(i);
+    if (!_fp16_keep_io_types && is_float(input->name())) {
+      input->mutable_type()->mutable_tensor_type()->set_elem_type(float16);
+      half_tensors.insert(input->name());
+    }
+  }
+
+  // Rebuild the nodes with the boundary casts between float32 and float16
+  std::vector<ONNX_NAMESPACE::NodeProto> nodes;
+  std::map<std::pair<std::string, int32_t>, std::string> casts;
+  auto make_cast = [&nodes](const std::string& input, const std::string& output,
+                            int32_t to) {
+    ONNX_NAMESPACE::NodeProto cast;
+    cast.set_name(MapperHelper::Get()->GenName("fp16.cast"));
+    cast.set_op_type("Cast");
+    cast.add_input(input);
+    cast.add_output(output);
+    auto attr = cast.add_attribute();
+    attr->set_name("to");
+    attr->set_type(ONNX_NAMESPACE::AttributeProto::INT);
+    attr->set_i(to);
+    nodes.push_back(cast);
+  };
+  for (auto i = 0; i < graph->node_size(); ++i) {
+    ONNX_NAMESPACE::NodeProto node = graph->node(i);
+    for (auto j = 0; j < node.input_size(); ++j) {
+      const std::string& name = node.input(j);
+      if (name.empty() || !is_float(name) || node.op_type() == "Cast") {
+        continue;
+      }
+      bool is_half = half_tensors.find(name) != half_tensors.end();
+      if (expects_half(i, j) == is_half) {
+        continue;
+      }
+      int32_t to = is_half ? float32 : float16;
+      auto iter = casts.find(std::make_pair(name, to));
+      if (iter == casts.end()) {
+        std::string output = MapperHelper::Get()->GenName("fp16.cast");
+        make_cast(name, output, to);
+        iter = casts.emplace(std::make_pair(name, to), output).first;
+      }
+      node.set_input(j, iter->second);
+    }
+    if (is_half_node[i]) {
+      int32_t cast_to = -1;
+      for (auto& attr : *node.mutable_attribute()) {
+        if (attr.has_t()) {
+          ConvertTensorToHalf(attr.mutable_t());
+        } else if (node.op_type() == "Cast" && attr.name() == "to") {
+          attr.set_i(attr.i() == float32 ? float16 : attr.i());
+          cast_to = attr.i();
+        }
+      }
+      // Cast to float16 from a float16 tensor does nothing
+      if (cast_to == float16 &&
+          half_tensors.find(node.input(0)) != half_tensors.end()) {
+        node.set_op_type("Identity");
+        node.clear_attribute();
+      }
+    }
+    nodes.push_back(node);
+  }
+
+  // Cast the float16 outputs back to float32 if the types of inputs and
+  // outputs should be kept
+  for (auto i = 0; i < graph->output_size(); ++i) {
+    auto output = graph->mutable_output(i);
+    if (half_tensors.find(output->name()) == half_tensors.end()) {
+      continue;
+    }
+    if (!_fp16_keep_io_types) {
+      output->mutable_type()->mutable_tensor_type()->set_elem_type(float16);
+      continue;
+    }
+    std::string renamed = MapperHelper::Get()->GenName("fp16.output");
+    for (auto& node : nodes) {
+      for (auto j = 0; j < node.input_size(); ++j) {
+        if (node.input(j) == output->name()) {
+          node.set_input(j, renamed);
+        }
+      }
+      for (auto j = 0; j < node.output_size(); ++j) {
+        if (node.output(j) == output->name()) {
+          node.set_output(j, renamed);
+        }
+      }
+    }
+    make_cast(renamed, output->name(), float32);
+  }
+
+  graph->clear_node();
+  for (auto& node : nodes) {
+    *(graph->add_node()) = node;
+  }
+  // The data types have been changed, value_info will be inferred again
+  graph->clear_value_info();
+}
+
+}  // namespace paddle2onnx
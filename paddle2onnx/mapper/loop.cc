@@ -12,10 +12,81 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cmath>
+#include <numeric>
+
 #include "paddle2onnx/mapper/exporter.h"
 
 namespace paddle2onnx {
 
+// The random operators and the control flow operators with subgraph should
+// stay in the loop body
+static bool IsHoistable(const ONNX_NAMESPACE::NodeProto& node) {
+  static const std::set<std::string> random_ops = {
+      "Bernoulli", "Multinomial", "RandomNormal", "RandomNormalLike",
+      "RandomUniform", "RandomUniformLike"};
+  if (random_ops.find(node.op_type()) != random_ops.end()) {
+    return false;
+  }
+  for (auto i = 0; i < node.attribute_size(); ++i) {
+    if (node.attribute(i).type() == ONNX_NAMESPACE::AttributeProto::GRAPH ||
+        node.attribute(i).type() == ONNX_NAMESPACE::AttributeProto::GRAPHS) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Rename the tensors used by the subgraphs of node, which are referenced from
+// the outer scope implicitly, the names defined in a subgraph shadow the outer
+// names and are kept
+static void RenameSubgraphInputs(
+    ONNX_NAMESPACE::NodeProto* node,
+    const std::unordered_map<std::string, std::string>& renamer) {
+  for (auto& attr : *(node->mutable_attribute())) {
+    std::vector<ONNX_NAMESPACE::GraphProto*> graphs;
+    if (attr.has_g()) {
+      graphs.push_back(attr.mutable_g());
+    }
+    for (auto& g : *(attr.mutable_graphs())) {
+      graphs.push_back(&g);
+    }
+    for (auto& graph : graphs) {
+      std::set<std::string> defined;
+      for (auto& item : graph->input()) {
+        defined.insert(item.name());
+      }
+      for (auto& item : graph->node()) {
+        defined.insert(item.output().begin(), item.output().end());
+      }
+      std::unordered_map<std::string, std::string> scoped_renamer;
+      for (auto& item : renamer) {
+        if (defined.find(item.first) == defined.end()) {
+          scoped_renamer.insert(item);
+        }
+      }
+      if (scoped_renamer.empty()) {
+        continue;
+      }
+      for (auto& sub_node : *(graph->mutable_node())) {
+        for (auto& input : *(sub_node.mutable_input())) {
+          auto iter = scoped_renamer.find(input);
+          if (iter != scoped_renamer.end()) {
+            input = iter->second;
+          }
+        }
+        RenameSubgraphInputs(&sub_node, scoped_renamer);
+      }
+      for (auto& output : *(graph->mutable_output())) {
+        auto iter = scoped_renamer.find(output.name());
+        if (iter != scoped_renamer.end()) {
+          output.set_name(iter->second);
+        }
+      }
+    }
+  }
+}
+
 bool ModelExporter::IsLoopSupported(const PaddleParser& parser,
                                     const int64_t& block_id,
                                     const int64_t& op_id) {
@@ -36,10 +107,261 @@ bool ModelExporter::IsLoopSupported(const PaddleParser& parser,
   return true;
 }
 
+bool ModelExporter::GetLoopCounter(const PaddleParser& parser,
+                                   int64_t sub_block_id,
+                                   const std::string& cond_name,
+                                   LoopCounter* counter) {
+  std::map<std::string, std::vector<int64_t>> writers;
+  for (auto i = 0; i < parser.NumOfOps(sub_block_id); ++i) {
+    auto& op = parser.GetOpDesc(sub_block_id, i);
+    for (auto j = 0; j < op.outputs_size(); ++j) {
+      for (auto k = 0; k < op.outputs(j).arguments_size(); ++k) {
+        writers[op.outputs(j).arguments(k)].push_back(i);
+      }
+    }
+  }
+  // The condition is updated by the last operator writes it, while_loop
+  // computes it into a temporary variable and assigns it back
+  auto iter = writers.find(cond_name);
+  if (iter == writers.end()) {
+    return false;
+  }
+  int64_t compare_id = iter->second.back();
+  if (parser.GetOpDesc(sub_block_id, compare_id).type() == "assign") {
+    auto assign_x = parser.GetOpInput(sub_block_id, compare_id, "X");
+    iter = writers.find(assign_x[0].name);
+    if (iter == writers.end() || iter->second.back() > compare_id) {
+      return false;
+    }
+    compare_id = iter->second.back();
+  }
+  auto& compare = parser.GetOpDesc(sub_block_id, compare_id);
+  if (compare.type() != "less_than" && compare.type() != "less_equal") {
+    return false;
+  }
+  auto x_info = parser.GetOpInput(sub_block_id, compare_id, "X");
+  auto y_info = parser.GetOpInput(sub_block_id, compare_id, "Y");
+  for (auto& info : {x_info[0], y_info[0]}) {
+    if (info.dtype != P2ODataType::INT32 && info.dtype != P2ODataType::INT64) {
+      return false;
+    }
+  }
+  // The limit should not be changed in the loop, and the counter should be
+  // only updated once before comparing
+  if (writers.find(y_info[0].name) != writers.end()) {
+    return false;
+  }
+  iter = writers.find(x_info[0].name);
+  if (iter == writers.end() || iter->second.size() != 1 ||
+      iter->second[0] > compare_id) {
+    return false;
+  }
+  int64_t update_id = iter->second[0];
+  auto& update = parser.GetOpDesc(sub_block_id, update_id);
+  if (update.type() != "increment" && update.type() != "scale") {
+    return false;
+  }
+  // The loop variable is updated in place, or assigned by the updated value
+  // like while_loop does
+  auto counter_name = parser.GetOpInput(sub_block_id, update_id, "X")[0].name;
+  if (counter_name != x_info[0].name) {
+    iter = writers.find(counter_name);
+    if (iter == writers.end() || iter->second.size() != 1) {
+      return false;
+    }
+    auto& assign = parser.GetOpDesc(sub_block_id, iter->second[0]);
+    if (assign.type() != "assign" ||
+        parser.GetOpInput(sub_block_id, iter->second[0], "X")[0].name !=
+            x_info[0].name) {
+      return false;
+    }
+  }
+  float step = 0.0;
+  if (update.type() == "increment") {
+    parser.GetOpAttr(update, "step", &step);
+  } else {
+    float scale = 1.0;
+    parser.GetOpAttr(update, "scale", &scale);
+    parser.GetOpAttr(update, "bias", &step);
+    if (parser.OpHasInput(sub_block_id, update_id, "ScaleTensor") ||
+        scale != 1.0) {
+      return false;
+    }
+  }
+  if (step < 1.0 || std::floor(step) != step) {
+    return false;
+  }
+  counter->counter = counter_name;
+  counter->limit = y_info[0].name;
+  counter->step = static_cast<int64_t>(step);
+  counter->inclusive = compare.type() == "less_equal";
+  counter->counter_dtype = x_info[0].dtype;
+  counter->limit_dtype = y_info[0].dtype;
+  return true;
+}
+
+std::string ModelExporter::LoopTripCount(const PaddleParser& parser,
+                                         OnnxHelper* helper,
+                                         int64_t sub_block_id,
+                                         const std::string& cond_name) {
+  LoopCounter counter;
+  if (!GetLoopCounter(parser, sub_block_id, cond_name, &counter)) {
+    return "";
+  }
+  // trip_count = max(ceil((limit - counter) / step), 1), and it's only an
+  // upper bound because Loop still checks the condition before each iteration
+  auto start = helper->AutoCast(counter.counter, counter.counter_dtype,
+                                P2ODataType::INT64);
+  auto limit = helper->AutoCast(counter.limit, counter.limit_dtype,
+                                P2ODataType::INT64);
+  int64_t offset = counter.inclusive ? counter.step : counter.step - 1;
+  auto offset_node =
+      helper->Constant({1}, ONNX_NAMESPACE::TensorProto::INT64, offset);
+  auto step_node =
+      helper->Constant({1}, ONNX_NAMESPACE::TensorProto::INT64, counter.step);
+  auto one_node =
+      helper->Constant({1}, ONNX_NAMESPACE::TensorProto::INT64, int64_t(1));
+  auto distance = helper->MakeNode("Sub", {limit, start})->output(0);
+  distance = helper->MakeNode("Add", {distance, offset_node})->output(0);
+  auto trip_count = helper->MakeNode("Div", {distance, step_node})->output(0);
+  trip_count = helper->MakeNode("Max", {trip_count, one_node})->output(0);
+  return helper->Reshape(trip_count, {1});
+}
+
+static bool IsWriter(const framework::proto::OpDesc& op,
+                     const std::string& name) {
+  for (auto i = 0; i < op.outputs_size(); ++i) {
+    for (auto j = 0; j < op.outputs(i).arguments_size(); ++j) {
+      if (op.outputs(i).arguments(j) == name) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Get the value of scalar variable `name`, which is assigned by fill_constant
+// or assign_value before operator `op_id`, or before the operator running
+// this block in the enclosing blocks
+static bool GetScalarValue(const PaddleParser& parser, int64_t block_id,
+                           int64_t op_id, const std::string& name,
+                           int64_t* value) {
+  for (auto i = op_id - 1; i >= 0; --i) {
+    auto& op = parser.GetOpDesc(block_id, i);
+    if (!IsWriter(op, name)) {
+      continue;
+    }
+    if (op.type() == "fill_constant") {
+      if (parser.OpHasInput(block_id, i, "ValueTensor") ||
+          parser.OpHasInput(block_id, i, "ShapeTensor") ||
+          parser.OpHasInput(block_id, i, "ShapeTensorList")) {
+        return false;
+      }
+      std::vector<int64_t> shape;
+      parser.GetOpAttr(op, "shape", &shape);
+      if (std::accumulate(shape.begin(), shape.end(), int64_t(1),
+                          std::multiplies<int64_t>()) != 1) {
+        return false;
+      }
+      double data = 0.0;
+      std::string str_value;
+      if (parser.OpHasAttr(op, "str_value")) {
+        parser.GetOpAttr(op, "str_value", &str_value);
+      }
+      if (!str_value.empty()) {
+        data = std::stod(str_value);
+      } else {
+        float float_value = 0.0;
+        parser.GetOpAttr(op, "value", &float_value);
+        data = float_value;
+      }
+      if (std::floor(data) != data) {
+        return false;
+      }
+      *value = static_cast<int64_t>(data);
+      return true;
+    }
+    if (op.type() == "assign_value") {
+      std::vector<int64_t> data;
+      if (parser.OpHasAttr(op, "int64_values")) {
+        parser.GetOpAttr(op, "int64_values", &data);
+      }
+      if (data.empty() && parser.OpHasAttr(op, "int32_values")) {
+        parser.GetOpAttr(op, "int32_values", &data);
+      }
+      if (data.size() != 1) {
+        return false;
+      }
+      *value = data[0];
+      return true;
+    }
+    return false;
+  }
+  if (block_id == 0) {
+    return false;
+  }
+  // The variable from the enclosing block should not be changed after
+  // `op_id`, otherwise it changes in the next iteration of this block
+  for (auto i = op_id + 1; i < parser.NumOfOps(block_id); ++i) {
+    if (IsWriter(parser.GetOpDesc(block_id, i), name)) {
+      return false;
+    }
+  }
+  int64_t parent_id = parser.prog->blocks(block_id).parent_idx();
+  for (auto i = 0; i < parser.NumOfOps(parent_id); ++i) {
+    auto& op = parser.GetOpDesc(parent_id, i);
+    for (auto& attr : op.attrs()) {
+      if (attr.name() == "sub_block" && attr.block_idx() == block_id) {
+        return GetScalarValue(parser, parent_id, i, name, value);
+      }
+    }
+  }
+  return false;
+}
+
+int64_t ModelExporter::StaticLoopTripCount(const PaddleParser& parser,
+                                           int64_t block_id, int64_t op_id,
+                                           int64_t sub_block_id,
+                                           const std::string& cond_name) {
+  LoopCounter counter;
+  if (!GetLoopCounter(parser, sub_block_id, cond_name, &counter)) {
+    return -1;
+  }
+  int64_t start = 0;
+  int64_t limit = 0;
+  if (!GetScalarValue(parser, block_id, op_id, counter.counter, &start) ||
+      !GetScalarValue(parser, block_id, op_id, counter.limit, &limit)) {
+    return -1;
+  }
+  // The initial condition should be computed by the same comparison as the
+  // loop body
+  for (auto i = op_id - 1; i >= 0; --i) {
+    auto& op = parser.GetOpDesc(block_id, i);
+    if (!parser.OpHasOutput(block_id, i, "Out") ||
+        parser.GetOpOutput(block_id, i, "Out")[0].name != cond_name) {
+      continue;
+    }
+    std::string compare = counter.inclusive ? "less_equal" : "less_than";
+    if (op.type() != compare ||
+        parser.GetOpInput(block_id, i, "X")[0].name != counter.counter ||
+        parser.GetOpInput(block_id, i, "Y")[0].name != counter.limit) {
+      return -1;
+    }
+    if (counter.inclusive) {
+      limit += 1;
+    }
+    if (start >= limit) {
+      return 0;
+    }
+    return (limit - start + counter.step - 1) / counter.step;
+  }
+  return -1;
+}
+
 void ModelExporter::ExportLoop(const PaddleParser& parser, OnnxHelper* helper,
                                int32_t opset_version, int64_t block_id,
                                int64_t op_id, bool verbose) {
-  auto op = parser.GetOpDesc(block_id, op_id);
+  auto& op = parser.GetOpDesc(block_id, op_id);
   int32_t sub_block_idx = -1;
   for (size_t i = 0; i < op.attrs_size(); ++i) {
     if (op.attrs(i).name() == "sub_block") {
@@ -56,6 +378,21 @@ void ModelExporter::ExportLoop(const PaddleParser& parser, OnnxHelper* helper,
              ")/outputs(" + std::to_string(out_info.size()) +
              ") be same for while operator.");
 
+  // Unroll the loop with small static trip count, the in-place updated
+  // variables are renamed by ProcessGraphDumplicateNames later
+  if (_loop_unroll_threshold > 0) {
+    int64_t trip_count = StaticLoopTripCount(parser, block_id, op_id,
+                                             sub_block_idx, cond_info[0].name);
+    if (trip_count >= 0 && trip_count <= _loop_unroll_threshold) {
+      for (auto i = 0; i < trip_count; ++i) {
+        for (auto j = 0; j < parser.NumOfOps(sub_block_idx); ++j) {
+          ExportOp(parser, helper, opset_version, sub_block_idx, j, verbose);
+        }
+      }
+      return;
+    }
+  }
+
   std::vector<std::shared_ptr<ONNX_NAMESPACE::ValueInfoProto>> inputs;
   std::vector<std::shared_ptr<ONNX_NAMESPACE::ValueInfoProto>> outputs;
 
@@ -84,9 +421,9 @@ void ModelExporter::ExportLoop(const PaddleParser& parser, OnnxHelper* helper,
   // make op nodes
   OnnxHelper loop_helper;
   loop_helper.SetOpsetVersion(opset_version);
+  loop_helper.SetTargetProfile(helper->target_profile);
 
   for (auto i = 0; i < parser.NumOfOps(sub_block_idx); ++i) {
-    auto op = parser.GetOpDesc(sub_block_idx, i);
     ExportOp(parser, &loop_helper, opset_version, sub_block_idx, i, verbose);
   }
 
@@ -109,6 +446,7 @@ void ModelExporter::ExportLoop(const PaddleParser& parser, OnnxHelper* helper,
         *(item->mutable_input(i)) = updated_name;
       }
     }
+    RenameSubgraphInputs(item.get(), renamer);
   }
   for (auto& item : outputs) {
     if (renamer.find(item->name()) != renamer.end()) {
@@ -120,6 +458,104 @@ void ModelExporter::ExportLoop(const PaddleParser& parser, OnnxHelper* helper,
     }
   }
 
+  // Hoist the loop invariant nodes out of the loop body, these nodes only
+  // depend on the outer graph, the carried variables not updated in the loop
+  // body and other invariant nodes
+  std::vector<std::string> carried_names;
+  for (size_t i = 0; i < x_info.size(); ++i) {
+    if (!x_info[i].is_tensor_array) {
+      carried_names.push_back(x_info[i].name);
+    }
+  }
+  std::vector<bool> is_updated(carried_names.size(), true);
+  std::unordered_map<std::string, std::string> outer_names;
+  std::set<std::string> variants = {inputs[0]->name(), inputs[1]->name()};
+  for (size_t i = 0; i < carried_names.size(); ++i) {
+    if (inputs[i + 2]->name() == outputs[i + 1]->name()) {
+      outer_names[inputs[i + 2]->name()] = carried_names[i];
+      is_updated[i] = false;
+    } else {
+      variants.insert(inputs[i + 2]->name());
+    }
+  }
+  std::set<std::string> body_outputs;
+  for (auto& item : outputs) {
+    body_outputs.insert(item->name());
+  }
+
+  std::unordered_map<std::string, std::string> hoisted_names;
+  std::set<std::string> used_outer_names;
+  std::vector<std::shared_ptr<ONNX_NAMESPACE::NodeProto>> body_nodes;
+  for (auto& item : loop_helper.nodes) {
+    bool hoistable = IsHoistable(*item);
+    // The nested Loop/If read the outer tensors implicitly, they are never
+    // hoisted, but the tensors they read should be renamed and kept as well
+    RenameSubgraphInputs(item.get(), hoisted_names);
+    CollectSubgraphInputs(*item, &used_outer_names);
+    for (size_t i = 0; i < item->input_size(); ++i) {
+      auto iter = hoisted_names.find(item->input(i));
+      if (iter != hoisted_names.end()) {
+        *(item->mutable_input(i)) = iter->second;
+      }
+      if (variants.find(item->input(i)) != variants.end()) {
+        hoistable = false;
+      }
+    }
+    for (size_t i = 0; i < item->output_size(); ++i) {
+      if (body_outputs.find(item->output(i)) != body_outputs.end()) {
+        hoistable = false;
+      }
+    }
+    if (!hoistable) {
+      for (size_t i = 0; i < item->input_size(); ++i) {
+        used_outer_names.insert(item->input(i));
+      }
+      for (size_t i = 0; i < item->output_size(); ++i) {
+        variants.insert(item->output(i));
+      }
+      body_nodes.push_back(item);
+      continue;
+    }
+    for (size_t i = 0; i < item->input_size(); ++i) {
+      auto iter = outer_names.find(item->input(i));
+      if (iter != outer_names.end()) {
+        *(item->mutable_input(i)) = iter->second;
+      }
+    }
+    for (size_t i = 0; i < item->output_size(); ++i) {
+      auto name = MapperHelper::Get()->GenName("loop.hoisted");
+      hoisted_names[item->output(i)] = name;
+      *(item->mutable_output(i)) = name;
+    }
+    helper->nodes.push_back(item);
+  }
+  loop_helper.nodes.swap(body_nodes);
+
+  // The carried variables not updated or used in the loop body are removed
+  // from the Loop
+  for (size_t i = 0; i < carried_names.size(); ++i) {
+    if (used_outer_names.find(inputs[i + 2]->name()) !=
+        used_outer_names.end()) {
+      is_updated[i] = true;
+    }
+  }
+
+  std::vector<std::shared_ptr<ONNX_NAMESPACE::ValueInfoProto>> loop_inputs = {
+      inputs[0], inputs[1]};
+  std::vector<std::shared_ptr<ONNX_NAMESPACE::ValueInfoProto>> loop_outputs = {
+      outputs[0]};
+  for (size_t i = 0; i < carried_names.size(); ++i) {
+    if (is_updated[i]) {
+      loop_inputs.push_back(inputs[i + 2]);
+      loop_outputs.push_back(outputs[i + 1]);
+    }
+  }
+  for (size_t i = carried_names.size() + 1; i < outputs.size(); ++i) {
+    loop_outputs.push_back(outputs[i]);
+  }
+  inputs.swap(loop_inputs);
+  outputs.swap(loop_outputs);
+
   //  // construct a onnx model proto
   //  // consider to optimize the subgraph
   //  auto model = std::make_shared<ONNX_NAMESPACE::ModelProto>();
@@ -145,19 +581,18 @@ void ModelExporter::ExportLoop(const PaddleParser& parser, OnnxHelper* helper,
     *(graph->add_output()) = (*item.get());
   }
 
-  // fake iter
-  auto fake_iter = helper->Constant(ONNX_NAMESPACE::TensorProto::INT64,
-                                    std::vector<int64_t>(1, 1024));
+  // The trip count is empty if it cannot be inferred, then Loop only stops
+  // by the condition
   std::vector<std::string> x_names;
-  x_names.push_back(fake_iter);
+  x_names.push_back(
+      LoopTripCount(parser, helper, sub_block_idx, cond_info[0].name));
   x_names.push_back(cond_info[0].name);
   std::vector<std::string> out_names;
-  for (size_t i = 0; i < x_info.size(); ++i) {
-    if (x_info[i].is_tensor_array) {
-      continue;
+  for (size_t i = 0; i < carried_names.size(); ++i) {
+    if (is_updated[i]) {
+      x_names.push_back(carried_names[i]);
+      out_names.push_back(carried_names[i]);
     }
-    x_names.push_back(x_info[i].name);
-    out_names.push_back(x_info[i].name);
   }
   for (size_t i = 0; i < x_info.size(); ++i) {
     if (x_info[i].is_tensor_array) {
@@ -195,6 +195,63 @@ class Mapper {
     auto input_info = GetInput(input_key);
     return parser_->TryGetTensorValue(block_idx_, input_info[0].name, data);
   }
+
+  // Return the weight if the input is a parameter of model, otherwise return
+  // nullptr
+  const Weight* GetParameter(const std::string& input_key) const {
+    auto input_info = GetInput(input_key);
+    auto iter = parser_->params.find(input_info[0].name);
+    if (iter == parser_->params.end()) {
+      return nullptr;
+    }
+    return &(iter->second);
+  }
+
+  bool IsParameterInput(const std::string& input_key) const {
+    return GetParameter(input_key) != nullptr;
+  }
+
+  // Whether the input is a parameter only read once by this operator, the
+  // exported parameter will be unused after being rewritten while exporting,
+  // otherwise the rewritten copy is exported besides the original parameter
+  bool IsExclusiveParameterInput(const std::string& input_key) const {
+    if (!IsParameterInput(input_key)) {
+      return false;
+    }
+    auto consumers = parser_->GetParamConsumers(GetInput(input_key)[0].name);
+    return consumers.size() == 1 && consumers[0].first == block_idx_ &&
+           consumers[0].second == op_idx_;
+  }
+
+  // Get value of the parameter and convert to data type T
+  template <typename T>
+  bool TryGetParameterValue(const std::string& input_key,
+                            std::vector<T>* data) const {
+    auto weight = GetParameter(input_key);
+    if (weight == nullptr) {
+      return false;
+    }
+    if (weight->dtype == P2ODataType::FP32) {
+      std::vector<float> value;
+      weight->get(&value);
+      data->assign(value.begin(), value.end());
+    } else if (weight->dtype == P2ODataType::FP64) {
+      std::vector<double> value;
+      weight->get(&value);
+      data->assign(value.begin(), value.end());
+    } else if (weight->dtype == P2ODataType::INT32) {
+      std::vector<int32_t> value;
+      weight->get(&value);
+      data->assign(value.begin(), value.end());
+    } else if (weight->dtype == P2ODataType::INT64) {
+      std::vector<int64_t> value;
+      weight->get(&value);
+      data->assign(value.begin(), value.end());
+    } else {
+      return false;
+    }
+    return true;
+  }
 };
 
 }  // namespace paddle2onnx
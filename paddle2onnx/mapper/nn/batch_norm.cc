@@ -28,11 +28,25 @@ void BatchNormMapper::Opset7() {
   auto variance_info = GetInput("Variance");
   auto output_info = GetOutput("Y");
 
+  // Channel is the last dimension while data_layout is NHWC, transpose it to
+  // the second dimension
+  std::string input = input_info[0].name;
+  std::string output = output_info[0].name;
+  int64_t rank = input_info[0].Rank();
+  bool channel_last = data_layout_ == "NHWC" && rank > 2;
+  std::vector<int64_t> perm = Arange(0, rank);
+  if (channel_last) {
+    perm.insert(perm.begin() + 1, rank - 1);
+    perm.pop_back();
+    input = helper_->Transpose(input, perm);
+    output = MapperHelper::Get()->GenName("batch_norm.output");
+  }
+
   auto node = helper_->MakeNode(
       "BatchNormalization",
-      {input_info[0].name, scale_info[0].name, bias_info[0].name,
-       mean_info[0].name, variance_info[0].name},
-      {output_info[0].name});
+      {input, scale_info[0].name, bias_info[0].name, mean_info[0].name,
+       variance_info[0].name},
+      {output});
   if (helper_->GetOpsetVersion() < 9) {
     int64_t spatial = 1;
     AddAttribute(node, "spatial", spatial);
@@ -40,6 +54,13 @@ void BatchNormMapper::Opset7() {
 
   AddAttribute(node, "epsilon", epsilon_);
   AddAttribute(node, "momentum", momentum_);
+  if (channel_last) {
+    std::vector<int64_t> inverse_perm(rank);
+    for (int64_t i = 0; i < rank; ++i) {
+      inverse_perm[perm[i]] = i;
+    }
+    helper_->Transpose(output, output_info[0].name, inverse_perm);
+  }
 }
 
 }  // namespace paddle2onnx
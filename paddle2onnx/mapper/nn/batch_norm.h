@@ -27,6 +27,9 @@ class BatchNormMapper : public Mapper {
       : Mapper(p, helper, block_id, op_id) {
     GetAttr("epsilon", &epsilon_);
     GetAttr("momentum", &momentum_);
+    if (HasAttr("data_layout")) {
+      GetAttr("data_layout", &data_layout_);
+    }
   }
 
   void Opset7();
@@ -34,6 +37,7 @@ class BatchNormMapper : public Mapper {
  private:
   float epsilon_;
   float momentum_;
+  std::string data_layout_ = "NCHW";
 };
 
 }  // namespace paddle2onnx
@@ -22,11 +22,6 @@ REGISTER_MAPPER(conv2d, Conv2dMapper)
 REGISTER_MAPPER(depthwise_conv2d, Conv2dMapper)
 
 int32_t Conv2dMapper::GetMinOpset(bool verbose) {
-  // NHWC is not supported
-  if (data_format_ == "NHWC") {
-    Error() << "Cannot support input with NHWC format." << std::endl;
-    return -1;
-  }
   if (padding_algorithm_ == "EXPLICIT") {
     if (paddings_.size() != 2 && paddings_.size() != 4) {
       Error() << "While padding_algorithm is EXPLICIT, size of paddings should "
@@ -51,6 +46,12 @@ void Conv2dMapper::Opset7() {
   auto output_info = GetOutput("Output");
   auto input = helper_->AutoCast(input_info[0].name, input_info[0].dtype,
                                  P2ODataType::FP32);
+  // The filter is [M, C/group, kH, kW] for both NCHW and NHWC, only transpose
+  // the input and output, the transposes between layers will be eliminated by
+  // optimizer
+  if (data_format_ == "NHWC") {
+    input = helper_->Transpose(input, {0, 3, 1, 2});
+  }
   auto kernel = helper_->AutoCast(kernel_info[0].name, kernel_info[0].dtype,
                                   P2ODataType::FP32);
   auto node = helper_->MakeNode("Conv", {input, kernel});
@@ -78,7 +79,11 @@ void Conv2dMapper::Opset7() {
     }
     AddAttribute(node, "pads", paddings);
   }
-  helper_->AutoCast(node->output(0), output_info[0].name, P2ODataType::FP32,
+  auto output = node->output(0);
+  if (data_format_ == "NHWC") {
+    output = helper_->Transpose(output, {0, 2, 3, 1});
+  }
+  helper_->AutoCast(output, output_info[0].name, P2ODataType::FP32,
                     output_info[0].dtype);
 }
 
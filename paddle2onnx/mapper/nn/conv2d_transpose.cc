@@ -22,13 +22,6 @@ REGISTER_MAPPER(conv2d_transpose, Conv2dTransposeMapper)
 REGISTER_MAPPER(depthwise_conv2d_transpose, Conv2dTransposeMapper)
 
 int32_t Conv2dTransposeMapper::GetMinOpset(bool verbose) {
-  // NHWC is not supported
-  if (data_format_ == "NHWC") {
-    Error() << "[ERROR] Cannot support NHWC format for operator "
-               "conv2d_transpose/depthwise_conv2d_transpose."
-            << std::endl;
-    return -1;
-  }
   return 7;
 }
 
@@ -38,6 +31,9 @@ void Conv2dTransposeMapper::Opset7() {
   auto output_info = GetOutput("Output");
   auto input = helper_->AutoCast(input_info[0].name, input_info[0].dtype,
                                  P2ODataType::FP32);
+  if (data_format_ == "NHWC") {
+    input = helper_->Transpose(input, {0, 3, 1, 2});
+  }
   auto kernel = helper_->AutoCast(kernel_info[0].name, kernel_info[0].dtype,
                                   P2ODataType::FP32);
   auto node = helper_->MakeNode("ConvTranspose", {input, kernel});
@@ -59,7 +55,11 @@ void Conv2dTransposeMapper::Opset7() {
   if (output_padding_.size() > 0) {
     AddAttribute(node, "output_padding", output_padding_);
   }
-  helper_->AutoCast(node->output(0), output_info[0].name, P2ODataType::FP32,
+  auto output = node->output(0);
+  if (data_format_ == "NHWC") {
+    output = helper_->Transpose(output, {0, 2, 3, 1});
+  }
+  helper_->AutoCast(output, output_info[0].name, P2ODataType::FP32,
                     output_info[0].dtype);
 }
 
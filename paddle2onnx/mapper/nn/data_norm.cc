@@ -14,30 +14,136 @@
 
 #include "paddle2onnx/mapper/nn/data_norm.h"
 
+#include <cmath>
+
 namespace paddle2onnx {
 REGISTER_MAPPER(data_norm, DataNormMapper)
 
 int32_t DataNormMapper::GetMinOpset(bool verbose) {
   if (slot_dim_ > 0) {
-    Error() << "slot_dim > 0 is not supported." << std::endl;
-    return -1;
+    auto input_info = GetInput("X");
+    if (enable_scale_and_shift_) {
+      Error() << "slot_dim > 0 is not supported while enable_scale_and_shift "
+                 "is true."
+              << std::endl;
+      return -1;
+    }
+    if (input_info[0].Rank() != 2 || input_info[0].shape[1] <= 0 ||
+        input_info[0].shape[1] % slot_dim_ != 0) {
+      Error() << "While slot_dim > 0, the input should be 2-D and the "
+                 "dimension 1 should be divisible by slot_dim."
+              << std::endl;
+      return -1;
+    }
   }
   return 7;
 }
 
+bool DataNormMapper::GetStatistics(std::vector<double>* mean,
+                                   std::vector<double>* scale) {
+  std::vector<double> batch_size;
+  std::vector<double> batch_sum;
+  std::vector<double> batch_square_sum;
+  if (!TryGetParameterValue("BatchSize", &batch_size) ||
+      !TryGetParameterValue("BatchSum", &batch_sum) ||
+      !TryGetParameterValue("BatchSquareSum", &batch_square_sum) ||
+      batch_size.size() != batch_sum.size() ||
+      batch_size.size() != batch_square_sum.size()) {
+    return false;
+  }
+  mean->resize(batch_size.size());
+  scale->resize(batch_size.size());
+  for (size_t i = 0; i < batch_size.size(); ++i) {
+    (*mean)[i] = batch_sum[i] / batch_size[i];
+    (*scale)[i] = std::sqrt(batch_size[i] / batch_square_sum[i]);
+  }
+  return true;
+}
+
 void DataNormMapper::Opset7() {
   auto input_info = GetInput("X");
+  auto output_info = GetOutput("Y");
+  auto dtype = GetOnnxDtype(input_info[0].dtype);
+
+  std::vector<double> mean_data;
+  std::vector<double> scale_data;
+  if (GetStatistics(&mean_data, &scale_data)) {
+    std::vector<double> scale_w;
+    std::vector<double> bias;
+    if (!enable_scale_and_shift_) {
+      auto mean = helper_->Constant(dtype, mean_data);
+      auto scale = helper_->Constant(dtype, scale_data);
+      auto out =
+          helper_->MakeNode("Sub", {input_info[0].name, mean})->output(0);
+      if (slot_dim_ <= 0) {
+        helper_->MakeNode("Mul", {out, scale}, {output_info[0].name});
+      } else {
+        out = helper_->MakeNode("Mul", {out, scale})->output(0);
+        MaskEmptySlots(out, output_info[0].name);
+      }
+      return;
+    }
+    if (TryGetParameterValue("scale_w", &scale_w) &&
+        TryGetParameterValue("bias", &bias) &&
+        scale_w.size() == scale_data.size() &&
+        bias.size() == scale_data.size()) {
+      // y = (x - mean) * scale * scale_w + bias = x * scale' + bias'
+      for (size_t i = 0; i < scale_data.size(); ++i) {
+        scale_data[i] *= scale_w[i];
+        bias[i] -= mean_data[i] * scale_data[i];
+      }
+      auto scale = helper_->Constant(dtype, scale_data);
+      auto shift = helper_->Constant(dtype, bias);
+      auto out =
+          helper_->MakeNode("Mul", {input_info[0].name, scale})->output(0);
+      helper_->MakeNode("Add", {out, shift}, {output_info[0].name});
+      return;
+    }
+  }
+
   auto batch_size_info = GetInput("BatchSize");
   auto batch_sum_info = GetInput("BatchSum");
   auto batch_square_sum_info = GetInput("BatchSquareSum");
-  auto output_info = GetOutput("Y");
+  auto mean =
+      helper_->MakeNode("Div", {batch_sum_info[0].name, batch_size_info[0].name})
+          ->output(0);
+  auto scale = helper_->MakeNode("Div", {batch_size_info[0].name,
+                                         batch_square_sum_info[0].name})
+                   ->output(0);
+  scale = helper_->MakeNode("Sqrt", {scale})->output(0);
+  auto out = helper_->MakeNode("Sub", {input_info[0].name, mean})->output(0);
+  if (enable_scale_and_shift_) {
+    auto scale_w_info = GetInput("scale_w");
+    auto bias_info = GetInput("bias");
+    out = helper_->MakeNode("Mul", {out, scale})->output(0);
+    out = helper_->MakeNode("Mul", {out, scale_w_info[0].name})->output(0);
+    helper_->MakeNode("Add", {out, bias_info[0].name}, {output_info[0].name});
+  } else if (slot_dim_ <= 0) {
+    helper_->MakeNode("Mul", {out, scale}, {output_info[0].name});
+  } else {
+    out = helper_->MakeNode("Mul", {out, scale})->output(0);
+    MaskEmptySlots(out, output_info[0].name);
+  }
+}
 
-  Assert(slot_dim_ <= 0, "slot_dim > 0 is not supported.");
-  auto mean_arr = helper_->MakeNode("Div", {batch_sum_info[0].name, batch_size_info[0].name})->output(0);
-  auto scale_arr = helper_->MakeNode("Div", {batch_size_info[0].name, batch_square_sum_info[0].name})->output(0);
-  scale_arr = helper_->MakeNode("Sqrt", {scale_arr})->output(0);
-  auto out = helper_->MakeNode("Sub", {input_info[0].name, mean_arr})->output(0);
-  helper_->MakeNode("Mul" ,{out, scale_arr}, {output_info[0].name});
+void DataNormMapper::MaskEmptySlots(const std::string& normalized,
+                                    const std::string& output) {
+  auto input_info = GetInput("X");
+  // The first value of each slot is the show number, the whole slot is zero
+  // while the show number is zero
+  int64_t num_slots = input_info[0].shape[1] / slot_dim_;
+  auto out = helper_->Reshape(normalized, {0, num_slots, slot_dim_});
+  auto input = helper_->Reshape(input_info[0].name, {0, num_slots, slot_dim_});
+  auto show = helper_->Slice(input, {2}, {0}, {1});
+  show = helper_->MakeNode("Abs", {show})->output(0);
+  auto min_precision =
+      helper_->Constant({}, GetOnnxDtype(input_info[0].dtype), 1e-7);
+  auto is_zero = helper_->MakeNode("Less", {show, min_precision})->output(0);
+  auto not_zero = helper_->MakeNode("Not", {is_zero})->output(0);
+  auto mask = helper_->AutoCast(not_zero, P2ODataType::BOOL,
+                                input_info[0].dtype);
+  out = helper_->MakeNode("Mul", {out, mask})->output(0);
+  helper_->Reshape(out, output, {0, input_info[0].shape[1]});
 }
 
 }  // namespace paddle2onnx
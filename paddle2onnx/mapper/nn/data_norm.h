@@ -30,15 +30,24 @@ class DataNormMapper : public Mapper {
     if (HasAttr("slot_dim")) {
       GetAttr("slot_dim", &slot_dim_);
     }
+    if (HasAttr("enable_scale_and_shift")) {
+      GetAttr("enable_scale_and_shift", &enable_scale_and_shift_);
+    }
   }
 
   int32_t GetMinOpset(bool verbose = false);
   void Opset7();
 
  private:
+  // Compute the mean and scale while the statistics are parameters
+  bool GetStatistics(std::vector<double>* mean, std::vector<double>* scale);
+  // Zero the slots whose show number(the first value of slot) is zero
+  void MaskEmptySlots(const std::string& normalized, const std::string& output);
+
   std::string data_layout_;
   float epsilon_;
   int64_t slot_dim_ = -1;
+  bool enable_scale_and_shift_ = false;
 };
 
 }  // namespace paddle2onnx
@@ -22,10 +22,6 @@ REGISTER_MAPPER(linear_interp_v2, InterpolateMapper)
 REGISTER_MAPPER(trilinear_interp_v2, InterpolateMapper)
 
 int32_t InterpolateMapper::GetMinOpset(bool verbose) {
-  if (data_layout_ == "NHWC") {
-    Error() << "Data format of NHWC is not supported." << std::endl;
-    return -1;
-  }
   auto x_info = GetInput("X");
   if (x_info[0].Rank() > 5 && x_info[0].Rank() < 3) {
     Error() << "Only support 3D/4D/5D tensor, but now its dimension is "
@@ -62,6 +58,18 @@ std::string InterpolateMapper::ComputeScale() {
 void InterpolateMapper::Opset11() {
   auto x_info = GetInput("X");
   auto out_info = GetOutput("Out");
+  // Resize works on channel first data, transpose the input and output while
+  // data_layout is channel last
+  std::string x = x_info[0].name;
+  std::string out = out_info[0].name;
+  int64_t rank = x_info[0].Rank();
+  if (IsChannelLast()) {
+    std::vector<int64_t> perm = Arange(0, rank);
+    perm.insert(perm.begin() + 1, rank - 1);
+    perm.pop_back();
+    x = helper_->Transpose(x, perm);
+    out = MapperHelper::Get()->GenName("interpolate.output");
+  }
   std::string coordinate_transformation_mode = "half_pixel";
   auto resize_type = resize_mapper_[method_];
   if (align_corners_) {
@@ -111,12 +119,11 @@ void InterpolateMapper::Opset11() {
                               std::vector<float>());
   }
   if (size != "") {
-    auto ipt_shape = helper_->MakeNode("Shape", {x_info[0].name})->output(0);
+    auto ipt_shape = helper_->MakeNode("Shape", {x})->output(0);
     auto nc = helper_->Slice(ipt_shape, {0}, {0}, {2});
     size = helper_->Concat({nc, size}, 0);
   }
-  auto node = helper_->MakeNode("Resize", {x_info[0].name, roi, scale, size},
-                                {out_info[0].name});
+  auto node = helper_->MakeNode("Resize", {x, roi, scale, size}, {out});
   Assert(resize_mapper_.find(OpType()) != resize_mapper_.end(),
          "Cannot find " + OpType() + " in resize_mapper.");
   AddAttribute(node, "mode", resize_mapper_[OpType()]);
@@ -126,6 +133,12 @@ void InterpolateMapper::Opset11() {
       coordinate_transformation_mode == "asymmetric") {
     AddAttribute(node, "nearest_mode", "floor");
   }
+  if (IsChannelLast()) {
+    std::vector<int64_t> perm = Arange(0, rank);
+    perm.erase(perm.begin() + 1);
+    perm.push_back(1);
+    helper_->Transpose(out, out_info[0].name, perm);
+  }
 }
 
 }  // namespace paddle2onnx
@@ -43,6 +43,10 @@ class InterpolateMapper : public Mapper {
  private:
   std::string ComputeOutSize();
   std::string ComputeScale();
+  bool IsChannelLast() const {
+    return data_layout_ == "NWC" || data_layout_ == "NHWC" ||
+           data_layout_ == "NDHWC";
+  }
   std::map<std::string, std::string> resize_mapper_;
   std::string method_;
   std::string data_layout_;
@@ -20,23 +20,62 @@
 namespace paddle2onnx {
 REGISTER_MAPPER(layer_norm, LayerNormMapper)
 
+std::string LayerNormMapper::NormWeight(
+    const std::string& key, const std::vector<int64_t>& normalized_shape,
+    const std::string& input_name) {
+  auto info = GetInput(key);
+  std::string name = info[0].name;
+  if (info[0].dtype != P2ODataType::FP32) {
+    name = helper_->AutoCast(name, info[0].dtype, P2ODataType::FP32);
+  }
+  // 1-D weight is already able to broadcast with input
+  if (normalized_shape.size() == 1) {
+    return name;
+  }
+  bool is_static = true;
+  for (auto& dim : normalized_shape) {
+    if (dim <= 0) {
+      is_static = false;
+    }
+  }
+  if (is_static) {
+    // reshape with constant shape, it will be folded into the weight
+    return helper_->Reshape(name, normalized_shape);
+  }
+  if (weight_shape_node_.empty()) {
+    auto shape_node = helper_->MakeNode("Shape", {input_name});
+    int64_t rank = begin_norm_axis_ + normalized_shape.size();
+    weight_shape_node_ =
+        helper_->Slice(shape_node->output(0), {0}, {begin_norm_axis_}, {rank});
+  }
+  auto reshape_node = helper_->MakeNode("Reshape", {name, weight_shape_node_});
+  return reshape_node->output(0);
+}
+
+// Expand layer_norm with the pattern which could be fused as LayerNorm by
+// onnxruntime: ReduceMean-Sub-Pow-ReduceMean-Add-Sqrt-Div-Mul-Add
 void LayerNormMapper::Opset7() {
   auto input_info = GetInput("X");
   auto output_info = GetOutput("Y");
 
-  std::string input_name = helper_->AutoCast(
-      input_info[0].name, input_info[0].dtype, P2ODataType::FP32);
+  std::string input_name = input_info[0].name;
+  if (input_info[0].dtype != P2ODataType::FP32) {
+    input_name = helper_->AutoCast(input_name, input_info[0].dtype,
+                                   P2ODataType::FP32);
+  }
 
   std::vector<int64_t> input_shape = input_info[0].shape;
   std::vector<int64_t> axes;
   for (auto i = begin_norm_axis_; i < input_shape.size(); i++) {
     axes.push_back(i);
   }
+  std::vector<int64_t> normalized_shape(input_shape.begin() + begin_norm_axis_,
+                                        input_shape.end());
 
   std::string epsilon_node =
-      helper_->Constant({1}, GetOnnxDtype(P2ODataType::FP32), epsilon_);
+      helper_->Constant({}, GetOnnxDtype(P2ODataType::FP32), epsilon_);
   std::string two_node =
-      helper_->Constant({1}, GetOnnxDtype(P2ODataType::FP32), 2.0);
+      helper_->Constant({}, GetOnnxDtype(P2ODataType::FP32), 2.0);
 
   auto mean_node = helper_->MakeNode("ReduceMean", {input_name});
   AddAttribute(mean_node, "axes", axes);
@@ -55,70 +94,38 @@ void LayerNormMapper::Opset7() {
 
   auto denominator_node = helper_->MakeNode("Sqrt", {add_eps_node->output(0)});
 
-  auto ipt_shape_node = helper_->MakeNode("Shape", {input_name});
-  std::vector<int64_t> slice_axes = {0};
-  std::vector<int64_t> start = {
-      static_cast<int64_t>(input_shape.size() - axes.size())};
-  std::vector<int64_t> end = {static_cast<int64_t>(input_shape.size())};
-  std::string weight_shape_node =
-      helper_->Slice(ipt_shape_node->output(0), slice_axes, start, end);
-
   bool has_input_Bias = HasInput("Bias");
   bool has_input_Scale = HasInput("Scale");
+  bool need_cast = output_info[0].dtype != P2ODataType::FP32;
+  std::string output_name = output_info[0].name;
+  if (need_cast) {
+    output_name = MapperHelper::Get()->GenName("layer_norm.out");
+  }
 
-  if (has_input_Bias && has_input_Scale) {
-    auto scale_info = GetInput("Scale");
-    auto bias_info = GetInput("Bias");
-    std::string scale_name = helper_->AutoCast(
-        scale_info[0].name, scale_info[0].dtype, P2ODataType::FP32);
-    std::string bias_name = helper_->AutoCast(
-        bias_info[0].name, bias_info[0].dtype, P2ODataType::FP32);
-    auto scale_node =
-        helper_->MakeNode("Reshape", {scale_name, weight_shape_node});
-    auto bias_node =
-        helper_->MakeNode("Reshape", {bias_name, weight_shape_node});
-    auto layer_norm_pre_node = helper_->MakeNode(
-        "Div", {numerator_node->output(0), denominator_node->output(0)});
-    auto layer_norm_node = helper_->MakeNode(
-        "Mul", {layer_norm_pre_node->output(0), scale_node->output(0)});
-    auto pre_cast_node = helper_->MakeNode(
-        "Add", {layer_norm_node->output(0), bias_node->output(0)});
-    helper_->AutoCast(pre_cast_node->output(0), output_info[0].name,
-                      P2ODataType::FP32, output_info[0].dtype);
-    return;
+  std::string result = output_name;
+  if (has_input_Scale || has_input_Bias) {
+    result = MapperHelper::Get()->GenName("layer_norm.div");
+  }
+  helper_->MakeNode("Div",
+                    {numerator_node->output(0), denominator_node->output(0)},
+                    {result});
+  if (has_input_Scale) {
+    auto scale_name = NormWeight("Scale", normalized_shape, input_name);
+    std::string mul_output = output_name;
+    if (has_input_Bias) {
+      mul_output = MapperHelper::Get()->GenName("layer_norm.mul");
+    }
+    helper_->MakeNode("Mul", {result, scale_name}, {mul_output});
+    result = mul_output;
   }
   if (has_input_Bias) {
-    auto bias_info = GetInput("Bias");
-    std::string bias_name = helper_->AutoCast(
-        bias_info[0].name, bias_info[0].dtype, P2ODataType::FP32);
-    auto bias_node =
-        helper_->MakeNode("Reshape", {bias_name, weight_shape_node});
-    auto layer_norm_node = helper_->MakeNode(
-        "Div", {numerator_node->output(0), denominator_node->output(0)});
-    auto pre_cast_node = helper_->MakeNode(
-        "Add", {layer_norm_node->output(0), bias_node->output(0)});
-    helper_->AutoCast(pre_cast_node->output(0), output_info[0].name,
-                      P2ODataType::FP32, output_info[0].dtype);
-    return;
+    auto bias_name = NormWeight("Bias", normalized_shape, input_name);
+    helper_->MakeNode("Add", {result, bias_name}, {output_name});
   }
-  if (has_input_Scale) {
-    auto scale_info = GetInput("Scale");
-    std::string scale_name = helper_->AutoCast(
-        scale_info[0].name, scale_info[0].dtype, P2ODataType::FP32);
-    auto scale_node =
-        helper_->MakeNode("Reshape", {scale_name, weight_shape_node});
-    auto layer_norm_node = helper_->MakeNode(
-        "Div", {numerator_node->output(0), denominator_node->output(0)});
-    auto pre_cast_node = helper_->MakeNode(
-        "Mul", {layer_norm_node->output(0), scale_node->output(0)});
-    helper_->AutoCast(pre_cast_node->output(0), output_info[0].name,
-                      P2ODataType::FP32, output_info[0].dtype);
-    return;
+  if (need_cast) {
+    helper_->AutoCast(output_name, output_info[0].name, P2ODataType::FP32,
+                      output_info[0].dtype);
   }
-  auto pre_cast_node = helper_->MakeNode(
-      "Div", {numerator_node->output(0), denominator_node->output(0)});
-  helper_->AutoCast(pre_cast_node->output(0), output_info[0].name,
-                    P2ODataType::FP32, output_info[0].dtype);
 }
 
 }  // namespace paddle2onnx
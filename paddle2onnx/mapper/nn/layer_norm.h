@@ -32,8 +32,14 @@ class LayerNormMapper : public Mapper {
   void Opset7();
 
  private:
+  // Return Scale/Bias with the shape of normalized dims, so it's able to
+  // broadcast with input
+  std::string NormWeight(const std::string& key,
+                         const std::vector<int64_t>& normalized_shape,
+                         const std::string& input_name);
   int64_t begin_norm_axis_;
   float epsilon_;
+  std::string weight_shape_node_;
 };
 
 }  // namespace paddle2onnx
@@ -146,14 +146,31 @@ void Pool2dMapper::NoAdaptivePool(const std::vector<TensorInfo>& input_info,
   }
 }
 
-int32_t Pool2dMapper::GetMinOpset(bool verbose) {
-  // NHWC is not supported
-  if (data_format_ == "NHWC") {
-    Error() << "NHWC format is not supported." << std::endl;
-    return -1;
+void Pool2dMapper::GetNCHWInfo(std::vector<TensorInfo>* input_info,
+                               std::vector<TensorInfo>* output_info,
+                               bool export_node) {
+  *input_info = GetInput("X");
+  *output_info = GetOutput("Out");
+  if (data_format_ != "NHWC") {
+    return;
+  }
+  std::vector<int64_t> perm = {0, 3, 1, 2};
+  auto input_shape = (*input_info)[0].shape;
+  auto output_shape = (*output_info)[0].shape;
+  for (size_t i = 0; i < perm.size(); ++i) {
+    (*input_info)[0].shape[i] = input_shape[perm[i]];
+    (*output_info)[0].shape[i] = output_shape[perm[i]];
+  }
+  if (export_node) {
+    (*input_info)[0].name = helper_->Transpose((*input_info)[0].name, perm);
+    (*output_info)[0].name = MapperHelper::Get()->GenName("pool2d.output");
   }
-  auto input_info = GetInput("X");
-  auto output_info = GetOutput("Out");
+}
+
+int32_t Pool2dMapper::GetMinOpset(bool verbose) {
+  std::vector<TensorInfo> input_info;
+  std::vector<TensorInfo> output_info;
+  GetNCHWInfo(&input_info, &output_info, false);
   if (adaptive_) {
     for (auto one_input : input_info) {
       for (auto i = 2; i < one_input.shape.size(); ++i) {
@@ -189,8 +206,9 @@ int32_t Pool2dMapper::GetMinOpset(bool verbose) {
 }
 
 void Pool2dMapper::Opset7() {
-  auto input_info = GetInput("X");
-  auto output_info = GetOutput("Out");
+  std::vector<TensorInfo> input_info;
+  std::vector<TensorInfo> output_info;
+  GetNCHWInfo(&input_info, &output_info, true);
 
   bool is_1x1_kernel = true;
   for (auto i : k_size_) {
@@ -211,6 +229,10 @@ void Pool2dMapper::Opset7() {
   } else {
     NoAdaptivePool(input_info, output_info);
   }
+  if (data_format_ == "NHWC") {
+    helper_->Transpose(output_info[0].name, GetOutput("Out")[0].name,
+                       {0, 2, 3, 1});
+  }
 }
 
 }  // namespace paddle2onnx
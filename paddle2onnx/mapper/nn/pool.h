@@ -48,6 +48,10 @@ class Pool2dMapper : public Mapper {
                     const std::vector<TensorInfo>& output_info);
   void NoAdaptivePool(const std::vector<TensorInfo>& input_info,
                       const std::vector<TensorInfo>& output_info);
+  // Get the input and output as NCHW, a Transpose is inserted for input while
+  // data_format is NHWC
+  void GetNCHWInfo(std::vector<TensorInfo>* input_info,
+                   std::vector<TensorInfo>* output_info, bool export_node);
   bool ceil_mod_;
   bool global_pooling_;
   bool adaptive_;
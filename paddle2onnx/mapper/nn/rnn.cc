@@ -31,7 +31,96 @@ std::string RnnMapper::ReformWeight(const std::string& weight, const int64_t& si
   return helper_->Concat(items, 1);
 }
 
+// Reorder the gates of each weight in WeightList[indices] and concatenate
+// them, the result is same with ReformWeight but computed while exporting
+bool RnnMapper::ReformWeightOnHost(const std::vector<int64_t>& indices,
+                                   const std::vector<int64_t>& perm,
+                                   Weight* weight) {
+  auto weight_list_info = GetInput("WeightList");
+  weight->buffer.clear();
+  for (size_t i = 0; i < indices.size(); ++i) {
+    auto iter = parser_->params.find(weight_list_info[indices[i]].name);
+    if (iter == parser_->params.end()) {
+      return false;
+    }
+    const Weight& item = iter->second;
+    if (i == 0) {
+      weight->dtype = item.dtype;
+      weight->shape = item.shape;
+    }
+    if (item.dtype != weight->dtype || item.shape != weight->shape ||
+        item.shape.size() == 0 || item.shape[0] % hidden_size_ != 0) {
+      return false;
+    }
+    size_t row_bytes = item.buffer.size() / item.shape[0];
+    for (size_t j = 0; j < perm.size(); j += 2) {
+      auto begin = item.buffer.begin() + perm[j] * hidden_size_ * row_bytes;
+      auto end = item.buffer.begin() + perm[j + 1] * hidden_size_ * row_bytes;
+      weight->buffer.insert(weight->buffer.end(), begin, end);
+    }
+  }
+  return true;
+}
+
+bool RnnMapper::MakeParamInputsOnHost(int64_t layer_index,
+                                      const std::vector<int64_t>& perm,
+                                      std::vector<std::string>* outputs) {
+  auto weight_list_info = GetInput("WeightList");
+  int64_t bidirect_len = is_bidirec_ ? 4 : 2;
+  int64_t num_directions = is_bidirec_ ? 2 : 1;
+  int64_t weight_start_idx = layer_index * bidirect_len;
+  int64_t bias_start_idx =
+      weight_start_idx + std::floor(weight_list_info.size() / 2);
+
+  std::vector<int64_t> input_indices;
+  std::vector<int64_t> hidden_indices;
+  std::vector<int64_t> bias_indices;
+  for (int64_t i = 0; i < bidirect_len; i += 2) {
+    input_indices.push_back(weight_start_idx + i);
+    hidden_indices.push_back(weight_start_idx + i + 1);
+    bias_indices.push_back(bias_start_idx + i);
+    bias_indices.push_back(bias_start_idx + i + 1);
+  }
+
+  Weight input_weight;
+  Weight hidden_weight;
+  Weight bias;
+  if (!ReformWeightOnHost(input_indices, perm, &input_weight) ||
+      !ReformWeightOnHost(hidden_indices, perm, &hidden_weight) ||
+      !ReformWeightOnHost(bias_indices, perm, &bias) ||
+      input_weight.shape.size() != 2 || hidden_weight.shape.size() != 2 ||
+      bias.shape.size() != 1) {
+    return false;
+  }
+  // W: [num_directions, gates * hidden_size, input_size]
+  // R: [num_directions, gates * hidden_size, hidden_size]
+  // B: [num_directions, 2 * gates * hidden_size]
+  input_weight.shape.insert(input_weight.shape.begin(), num_directions);
+  hidden_weight.shape.insert(hidden_weight.shape.begin(), num_directions);
+  bias.shape = {static_cast<int32_t>(num_directions), 2 * bias.shape[0]};
+
+  outputs->clear();
+  outputs->push_back(helper_->Constant(input_weight));
+  outputs->push_back(helper_->Constant(hidden_weight));
+  outputs->push_back(helper_->Constant(bias));
+  outputs->push_back("");
+  return true;
+}
+
 std::vector<std::string> RnnMapper::MakeParamInputs(int64_t layer_index) {
+  std::vector<int64_t> reform_permutation;
+  if (mode_ == "LSTM") {
+    std::vector<int64_t> perm({0, 1, 3, 4, 1, 3});
+    reform_permutation.assign(perm.begin(), perm.end());
+  } else if (mode_ == "GRU") {
+    std::vector<int64_t> perm({1, 2, 0, 1, 2, 3});
+    reform_permutation.assign(perm.begin(), perm.end());
+  }
+  std::vector<std::string> outputs;
+  if (MakeParamInputsOnHost(layer_index, reform_permutation, &outputs)) {
+    return outputs;
+  }
+
   auto weight_list_info = GetInput("WeightList");
   int64_t bidirect_len = is_bidirec_ ? 4 : 2;
   int64_t all_layer_param_len = weight_list_info.size();
@@ -71,20 +160,11 @@ std::vector<std::string> RnnMapper::MakeParamInputs(int64_t layer_index) {
   auto input_bias_tensor = helper_->Concat(input_bias, 0);
   auto hidden_bias_tensor = helper_->Concat(hidden_bias, 0);
 
-  std::vector<int64_t> reform_permutation;
-  if (mode_ == "LSTM") {
-    std::vector<int64_t> perm({0, 1, 3, 4, 1, 3});
-    reform_permutation.assign(perm.begin(), perm.end());
-  } else if (mode_ == "GRU") {
-    std::vector<int64_t> perm({1, 2, 0, 1, 2, 3});
-    reform_permutation.assign(perm.begin(), perm.end());
-  }
   input_weight_tensor = ReformWeight(input_weight_tensor, hidden_size_, reform_permutation);
   hidden_weight_tensor = ReformWeight(hidden_weight_tensor, hidden_size_, reform_permutation);
   input_bias_tensor = ReformWeight(input_bias_tensor, hidden_size_, reform_permutation);
   hidden_bias_tensor = ReformWeight(hidden_bias_tensor, hidden_size_, reform_permutation);
-  
-  std::vector<std::string> outputs;
+
   outputs.push_back(input_weight_tensor);
   outputs.push_back(hidden_weight_tensor);
   outputs.push_back(helper_->Concat({input_bias_tensor, hidden_bias_tensor}, 1));
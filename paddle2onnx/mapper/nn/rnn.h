@@ -45,6 +45,11 @@ class RnnMapper : public Mapper {
   std::vector<std::string> MakeParamInputs(int64_t layer_index);
   std::vector<std::string> MakeInitParamInputs(int64_t layer_index);
   std::string ReformWeight(const std::string& weight, const int64_t& size, const std::vector<int64_t>& perm);
+  bool ReformWeightOnHost(const std::vector<int64_t>& indices,
+                          const std::vector<int64_t>& perm, Weight* weight);
+  bool MakeParamInputsOnHost(int64_t layer_index,
+                             const std::vector<int64_t>& perm,
+                             std::vector<std::string>* outputs);
   int64_t num_layers_;
   int64_t input_size_;
   int64_t hidden_size_;
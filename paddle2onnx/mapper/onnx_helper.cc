@@ -70,7 +70,8 @@ void AddAttribute(std::shared_ptr<ONNX_NAMESPACE::NodeProto> node,
 }
 
 ONNX_NAMESPACE::TensorProto_DataType GetOnnxDtype(int32_t paddle_dtype) {
-  Assert((paddle_dtype >= 0 && paddle_dtype <= 6) || paddle_dtype == 20,
+  Assert((paddle_dtype >= 0 && paddle_dtype <= 6) || paddle_dtype == 20 ||
+             paddle_dtype == 21,
          "Unknow paddle data type: " + std::to_string(paddle_dtype) +
              " While call GetOnnxDtype.");
   auto onnx_dtype = ONNX_NAMESPACE::TensorProto::FLOAT;
@@ -88,6 +89,8 @@ ONNX_NAMESPACE::TensorProto_DataType GetOnnxDtype(int32_t paddle_dtype) {
     onnx_dtype = ONNX_NAMESPACE::TensorProto::FLOAT;
   } else if (paddle_dtype == P2ODataType::FP64) {
     onnx_dtype = ONNX_NAMESPACE::TensorProto::DOUBLE;
+  } else if (paddle_dtype == P2ODataType::INT8) {
+    onnx_dtype = ONNX_NAMESPACE::TensorProto::INT8;
   } else {
     onnx_dtype = ONNX_NAMESPACE::TensorProto::UINT8;
   }
@@ -149,11 +152,34 @@ std::shared_ptr<ONNX_NAMESPACE::ValueInfoProto> MakeValueInfo(
   tensor_type_proto->set_elem_type(GetOnnxDtype(info.dtype));
   auto shape = tensor_type_proto->mutable_shape();
   for (auto& dim : info.shape) {
-    shape->add_dim()->set_dim_value(dim);
+    // The dynamic dimension is left unknown instead of -1
+    auto shape_dim = shape->add_dim();
+    if (dim >= 0) {
+      shape_dim->set_dim_value(dim);
+    }
   }
   return value_info;
 }
 
+void CollectSubgraphInputs(const ONNX_NAMESPACE::NodeProto& node,
+                           std::set<std::string>* names) {
+  for (auto& attr : node.attribute()) {
+    std::vector<const ONNX_NAMESPACE::GraphProto*> graphs;
+    if (attr.has_g()) {
+      graphs.push_back(&attr.g());
+    }
+    for (auto& g : attr.graphs()) {
+      graphs.push_back(&g);
+    }
+    for (auto& graph : graphs) {
+      for (auto& sub_node : graph->node()) {
+        names->insert(sub_node.input().begin(), sub_node.input().end());
+        CollectSubgraphInputs(sub_node, names);
+      }
+    }
+  }
+}
+
 std::shared_ptr<ONNX_NAMESPACE::NodeProto> OnnxHelper::MakeNode(
     const std::string& op_type, const std::vector<std::string>& inputs,
     const std::vector<std::string>& outputs) {
@@ -440,6 +466,12 @@ std::vector<std::string> OnnxHelper::Split(const std::string& input,
   }
   return Split(input, outputs, split, axis);
 }
+std::string OnnxHelper::Constant(const Weight& weight) {
+  auto output = MapperHelper::Get()->GenName("helper.constant");
+  nodes.push_back(MakeConstant(output, weight));
+  return output;
+}
+
 std::vector<std::string> OnnxHelper::DtypeAlignment(
     const std::vector<TensorInfo>& input_info, int32_t* out_dtype) {
   Assert(input_info.size() > 0,
@@ -17,6 +17,7 @@
 #include <onnx/onnx_pb.h>
 
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -44,12 +45,18 @@ std::shared_ptr<ONNX_NAMESPACE::NodeProto> MakeConstant(const std::string& name,
                                                         const Weight& weight);
 std::shared_ptr<ONNX_NAMESPACE::ValueInfoProto> MakeValueInfo(
     const TensorInfo& info);
+// Collect the tensor names used in the subgraphs of node
+void CollectSubgraphInputs(const ONNX_NAMESPACE::NodeProto& node,
+                           std::set<std::string>* names);
 
 class OnnxHelper {
  public:
   std::vector<std::shared_ptr<ONNX_NAMESPACE::NodeProto>> nodes;
   std::vector<std::shared_ptr<ONNX_NAMESPACE::ValueInfoProto>> value_infos;
   int32_t opset_version = 7;
+  // The inference engine the exported model targets, the fused operators of
+  // onnxruntime(domain com.microsoft) are emitted with "onnxruntime-cpu"
+  std::string target_profile = "standard";
 
   void Clear() { nodes.clear(); }
 
@@ -57,6 +64,14 @@ class OnnxHelper {
 
   int32_t GetOpsetVersion() { return opset_version; }
 
+  void SetTargetProfile(const std::string& profile) {
+    target_profile = profile;
+  }
+
+  bool IsOnnxRuntimeTarget() const {
+    return target_profile.find("onnxruntime") == 0;
+  }
+
   std::shared_ptr<ONNX_NAMESPACE::NodeProto> MakeNode(
       const std::string& op_type, const std::vector<std::string>& inputs,
       const std::vector<std::string>& outputs);
@@ -150,6 +165,9 @@ class OnnxHelper {
                        ONNX_NAMESPACE::TensorProto_DataType dtype,
                        std::vector<T>& value);
 
+  // Export a weight which is computed while converting as constant
+  std::string Constant(const Weight& weight);
+
   template <typename T>
   std::string Assign(const std::string& output,
                      const ONNX_NAMESPACE::TensorProto_DataType& dtype,
@@ -0,0 +1,201 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle2onnx/mapper/quantize/fake_quantize_dequantize.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace paddle2onnx {
+REGISTER_MAPPER(fake_quantize_dequantize_abs_max, FakeQuantizeDequantizeMapper)
+REGISTER_MAPPER(fake_quantize_dequantize_moving_average_abs_max,
+                FakeQuantizeDequantizeMapper)
+REGISTER_MAPPER(fake_channel_wise_quantize_dequantize_abs_max,
+                FakeQuantizeDequantizeMapper)
+
+int32_t FakeQuantizeDequantizeMapper::GetMinOpset(bool verbose) {
+  auto x_info = GetInput("X");
+  if (x_info[0].dtype != P2ODataType::FP32) {
+    Error() << "Only support input data type of float32." << std::endl;
+    return -1;
+  }
+  if (bit_length_ < 2 || bit_length_ > 8) {
+    Error() << "bit_length = " << bit_length_ << " is not supported."
+            << std::endl;
+    return -1;
+  }
+  bool is_weight = IsParameterInput("X");
+  // Values out of the int8 range can only be handled by quantizing while
+  // exporting
+  if (!is_weight && bit_length_ != 8) {
+    Error() << "Only support bit_length = 8 while the input is not a "
+               "parameter."
+            << std::endl;
+    return -1;
+  }
+  if (IsMovingAverage() && !IsParameterInput("InScale")) {
+    Error() << "The input InScale should be a parameter." << std::endl;
+    return -1;
+  }
+  if (IsChannelWise()) {
+    if (!is_weight) {
+      Error() << "Channel-wise quantization is only supported while the input "
+                 "is a parameter."
+              << std::endl;
+      return -1;
+    }
+    if (quant_axis_ < 0 || quant_axis_ >= x_info[0].Rank()) {
+      Error() << "quant_axis = " << quant_axis_ << " is out of range."
+              << std::endl;
+      return -1;
+    }
+    Logger(verbose, 13) << "While quantizing per channel, " << RequireOpset(13)
+                        << std::endl;
+    return 13;
+  }
+  return 10;
+}
+
+bool FakeQuantizeDequantizeMapper::GetAbsMax(std::vector<float>* abs_max) {
+  if (IsMovingAverage()) {
+    return TryGetParameterValue("InScale", abs_max) && abs_max->size() == 1;
+  }
+  auto weight = GetParameter("X");
+  std::vector<float> data;
+  if (weight == nullptr || !TryGetParameterValue("X", &data)) {
+    return false;
+  }
+  int64_t channels = 1;
+  int64_t inner_size = static_cast<int64_t>(data.size());
+  if (IsChannelWise()) {
+    channels = weight->shape[quant_axis_];
+    inner_size = 1;
+    for (size_t i = quant_axis_ + 1; i < weight->shape.size(); ++i) {
+      inner_size *= weight->shape[i];
+    }
+  }
+  abs_max->assign(channels, 0.0);
+  for (size_t i = 0; i < data.size(); ++i) {
+    auto& value = (*abs_max)[(i / inner_size) % channels];
+    value = std::max(value, std::fabs(data[i]));
+  }
+  return true;
+}
+
+std::string FakeQuantizeDequantizeMapper::QuantizeWeight(
+    const std::vector<float>& abs_max) {
+  auto weight = GetParameter("X");
+  std::vector<float> data;
+  TryGetParameterValue("X", &data);
+  int64_t channels = static_cast<int64_t>(abs_max.size());
+  int64_t inner_size = static_cast<int64_t>(data.size());
+  if (IsChannelWise()) {
+    inner_size = 1;
+    for (size_t i = quant_axis_ + 1; i < weight->shape.size(); ++i) {
+      inner_size *= weight->shape[i];
+    }
+  }
+  float bnt = (1 << (bit_length_ - 1)) - 1;
+  std::vector<int8_t> quantized(data.size());
+  for (size_t i = 0; i < data.size(); ++i) {
+    float scale = abs_max[(i / inner_size) % channels];
+    float value = scale > 0 ? data[i] / scale * bnt : 0.0;
+    value = round_type_ == 0 ? std::nearbyint(value) : std::round(value);
+    quantized[i] = static_cast<int8_t>(std::min(std::max(value, -bnt), bnt));
+  }
+  Weight result;
+  std::vector<int64_t> shape(weight->shape.begin(), weight->shape.end());
+  result.set(P2ODataType::INT8, shape, quantized);
+  return helper_->Constant(result);
+}
+
+std::string FakeQuantizeDequantizeMapper::ZeroPoint(int64_t numel) {
+  Weight zero_point;
+  std::vector<int64_t> shape;
+  if (IsChannelWise()) {
+    shape.push_back(numel);
+  }
+  zero_point.set(P2ODataType::INT8, shape, std::vector<int8_t>(numel, 0));
+  return helper_->Constant(zero_point);
+}
+
+void FakeQuantizeDequantizeMapper::Opset10() {
+  auto x_info = GetInput("X");
+  auto out_info = GetOutput("Out");
+  float bnt = (1 << (bit_length_ - 1)) - 1;
+
+  std::vector<float> abs_max;
+  if (GetAbsMax(&abs_max)) {
+    if (HasOutput("OutScale")) {
+      helper_->Constant(GetOutput("OutScale")[0].name,
+                        ONNX_NAMESPACE::TensorProto::FLOAT, abs_max);
+    }
+    std::vector<float> scales;
+    for (auto& value : abs_max) {
+      // Avoid zero scale, the quantized values are zeros in this case
+      scales.push_back(value > 0 ? value / bnt : 1.0);
+    }
+    std::string scale;
+    if (IsChannelWise()) {
+      scale = helper_->Constant(ONNX_NAMESPACE::TensorProto::FLOAT, scales);
+    } else {
+      scale = helper_->Constant({}, ONNX_NAMESPACE::TensorProto::FLOAT,
+                                scales[0]);
+    }
+    auto zero_point = ZeroPoint(scales.size());
+    // QuantizeLinear saturates to [-128, 127] while Paddle clips to
+    // [-127, 127], they are only different on the saturated values
+    std::string quantized;
+    if (IsParameterInput("X")) {
+      quantized = QuantizeWeight(abs_max);
+    } else {
+      quantized = helper_
+                      ->MakeNode("QuantizeLinear",
+                                 {x_info[0].name, scale, zero_point})
+                      ->output(0);
+    }
+    auto node = helper_->MakeNode("DequantizeLinear",
+                                  {quantized, scale, zero_point},
+                                  {out_info[0].name});
+    if (IsChannelWise()) {
+      AddAttribute(node, "axis", quant_axis_);
+    }
+    return;
+  }
+
+  // The scale of fake_quantize_dequantize_abs_max is computed from the input
+  // while inferencing
+  auto abs = helper_->MakeNode("Abs", {x_info[0].name})->output(0);
+  auto reduce_max = helper_->MakeNode("ReduceMax", {abs});
+  AddAttribute(reduce_max, "keepdims", int64_t(0));
+  if (HasOutput("OutScale")) {
+    helper_->Reshape(reduce_max->output(0), GetOutput("OutScale")[0].name,
+                     {1});
+  }
+  auto min_scale = helper_->Constant({}, ONNX_NAMESPACE::TensorProto::FLOAT,
+                                     float(1e-30));
+  auto scale = helper_->MakeNode("Max", {reduce_max->output(0), min_scale})
+                   ->output(0);
+  auto range =
+      helper_->Constant({}, ONNX_NAMESPACE::TensorProto::FLOAT, bnt);
+  scale = helper_->MakeNode("Div", {scale, range})->output(0);
+  auto zero_point = ZeroPoint(1);
+  auto quantized =
+      helper_->MakeNode("QuantizeLinear", {x_info[0].name, scale, zero_point})
+          ->output(0);
+  helper_->MakeNode("DequantizeLinear", {quantized, scale, zero_point},
+                    {out_info[0].name});
+}
+
+}  // namespace paddle2onnx
@@ -0,0 +1,63 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <string>
+#include <vector>
+
+#include "paddle2onnx/mapper/mapper.h"
+
+namespace paddle2onnx {
+
+// Export the fake quantize-dequantize operators of quantization-aware
+// trained models as QuantizeLinear + DequantizeLinear, the weights are
+// quantized to int8 while exporting and only DequantizeLinear is kept
+class FakeQuantizeDequantizeMapper : public Mapper {
+ public:
+  FakeQuantizeDequantizeMapper(const PaddleParser& p, OnnxHelper* helper,
+                               int64_t block_id, int64_t op_id)
+      : Mapper(p, helper, block_id, op_id) {
+    GetAttr("bit_length", &bit_length_);
+    if (HasAttr("round_type")) {
+      GetAttr("round_type", &round_type_);
+    }
+    if (HasAttr("quant_axis")) {
+      GetAttr("quant_axis", &quant_axis_);
+    }
+  }
+
+  int32_t GetMinOpset(bool verbose = false);
+  void Opset10();
+
+ private:
+  bool IsChannelWise() const {
+    return OpType() == "fake_channel_wise_quantize_dequantize_abs_max";
+  }
+  bool IsMovingAverage() const {
+    return OpType() == "fake_quantize_dequantize_moving_average_abs_max";
+  }
+  // Get the abs max values(one per channel for channel-wise quantization)
+  // while exporting, this is only available for the parameter input or the
+  // moving average scale
+  bool GetAbsMax(std::vector<float>* abs_max);
+  std::string QuantizeWeight(const std::vector<float>& abs_max);
+  std::string ZeroPoint(int64_t numel);
+
+  int64_t bit_length_ = 8;
+  // 0: rounding half to even, 1: rounding half away from zero
+  int64_t round_type_ = 1;
+  int64_t quant_axis_ = 0;
+};
+
+}  // namespace paddle2onnx
@@ -13,8 +13,12 @@
 // limitations under the License.
 
 #pragma once
+#include <algorithm>
 #include <fstream>
-#include <map>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 #include "paddle2onnx/utils/utils.h"
 // This code is modified from
@@ -23,27 +27,83 @@ namespace paddle2onnx {
 class Mapper;
 class PaddleParser;
 class OnnxHelper;
-#define REGISTER_MAPPER(op_name, class_name)                            \
-  class op_name##Generator : public Generator {                         \
-   public:                                                              \
-    op_name##Generator() { MapperHelper::Get()->Push(#op_name, this); } \
-    Mapper* Create(const PaddleParser& p, OnnxHelper* h, int64_t b,     \
-                   int64_t o) {                                         \
-      return new class_name(p, h, b, o);                                \
-    }                                                                   \
-  };                                                                    \
+// Every generator owns a slot which is able to hold one instance of its
+// mapper, Acquire() constructs the mapper inside this slot so that
+// converting an operator doesn't need any heap allocation. If the slot is
+// already occupied(nested conversion), it falls back to `new`.
+#define REGISTER_MAPPER(op_name, class_name)                              \
+  class op_name##Generator : public Generator {                           \
+   public:                                                                \
+    op_name##Generator() { MapperHelper::Get()->Push(#op_name, this); }   \
+    Mapper* Create(const PaddleParser& p, OnnxHelper* h, int64_t b,       \
+                   int64_t o) {                                           \
+      return new class_name(p, h, b, o);                                  \
+    }                                                                     \
+    Mapper* Acquire(const PaddleParser& p, OnnxHelper* h, int64_t b,      \
+                    int64_t o) {                                          \
+      if (in_use_) {                                                      \
+        return Create(p, h, b, o);                                        \
+      }                                                                   \
+      in_use_ = true;                                                     \
+      return new (&slot_) class_name(p, h, b, o);                         \
+    }                                                                     \
+    void Release(Mapper* m) {                                             \
+      if (static_cast<void*>(m) == static_cast<void*>(&slot_)) {          \
+        static_cast<class_name*>(m)->~class_name();                       \
+        in_use_ = false;                                                  \
+      } else {                                                            \
+        delete m;                                                         \
+      }                                                                   \
+    }                                                                     \
+                                                                          \
+   private:                                                               \
+    std::aligned_storage<sizeof(class_name), alignof(class_name)>::type   \
+        slot_;                                                            \
+    bool in_use_ = false;                                                 \
+  };                                                                      \
   op_name##Generator* op_name##inst = new op_name##Generator();
 
 class Generator {
  public:
   virtual Mapper* Create(const PaddleParser&, OnnxHelper* helper, int64_t,
                          int64_t) = 0;
+  virtual Mapper* Acquire(const PaddleParser&, OnnxHelper* helper, int64_t,
+                          int64_t) = 0;
+  virtual void Release(Mapper* mapper) = 0;
+};
+
+// Scoped mapper which is acquired from a generator, the mapper will be
+// returned to the generator while leaving the scope
+class MapperHandle {
+ public:
+  MapperHandle(Generator* generator, Mapper* mapper)
+      : generator_(generator), mapper_(mapper) {}
+  MapperHandle(const MapperHandle&) = delete;
+  MapperHandle& operator=(const MapperHandle&) = delete;
+  MapperHandle(MapperHandle&& other)
+      : generator_(other.generator_), mapper_(other.mapper_) {
+    other.mapper_ = nullptr;
+  }
+  ~MapperHandle() {
+    if (mapper_ != nullptr) {
+      generator_->Release(mapper_);
+    }
+  }
+  Mapper* get() const { return mapper_; }
+  Mapper* operator->() const { return mapper_; }
+
+ private:
+  Generator* generator_;
+  Mapper* mapper_;
 };
 
 class MapperHelper {
  private:
-  std::map<std::string, Generator*> mappers;
-  std::map<std::string, int64_t> name_counter;
+  // op type is interned to a dense id, which indexes the flat generators
+  std::unordered_map<std::string, int32_t> op_ids;
+  std::vector<std::string> op_names;
+  std::vector<Generator*> generators;
+  std::unordered_map<std::string, int64_t> name_counter;
   MapperHelper() {}
 
  public:
@@ -59,49 +119,81 @@ class MapperHelper {
     std::ofstream outfile(file_path);
     if (!outfile) {
       std::cerr << "Failed to open file: " << file_path << std::endl;
-      return mappers.size();
+      return generators.size();
     }
-    for (auto iter = mappers.begin(); iter != mappers.end(); iter++) {
-      outfile << iter->first << std::endl;
+    std::vector<std::string> names(op_names);
+    std::sort(names.begin(), names.end());
+    for (auto& name : names) {
+      outfile << name << std::endl;
     }
-    outfile << "Total OPs: " << mappers.size() << std::endl;
+    outfile << "Total OPs: " << generators.size() << std::endl;
     std::cout << " [ * Paddle2ONNX * ] All Registered OPs saved in "
               << file_path << std::endl;
     outfile.close();
-    return mappers.size();
+    return generators.size();
   }
 
-  bool IsRegistered(const std::string& op_name) {
-    auto iter = mappers.find(op_name);
-    if (mappers.end() == iter) {
-      return false;
+  // Return the interned id of op type, -1 means the op is not registered
+  int32_t GetOpId(const std::string& op_name) const {
+    auto iter = op_ids.find(op_name);
+    if (op_ids.end() == iter) {
+      return -1;
     }
-    return true;
+    return iter->second;
+  }
+
+  bool IsRegistered(const std::string& op_name) const {
+    return GetOpId(op_name) >= 0;
   }
 
   std::string GenName(const std::string& op_name) {
     std::string key = "p2o." + op_name + ".";
-    if (name_counter.find(key) == name_counter.end()) {
-      name_counter[key] = 0;
+    auto iter = name_counter.find(key);
+    if (iter == name_counter.end()) {
+      iter = name_counter.emplace(key, 0).first;
     } else {
-      name_counter[key] += 1;
+      iter->second += 1;
     }
-    return key + std::to_string(name_counter[key]);
+    return key + std::to_string(iter->second);
   }
 
   void ClearNameCounter() { name_counter.clear(); }
 
+  // The returned mapper is allocated on heap, and should be deleted by caller
   Mapper* CreateMapper(const std::string& name, const PaddleParser& parser,
                        OnnxHelper* helper, int64_t block_id, int64_t op_id) {
-    Assert(mappers.find(name) != mappers.end(),
-           name + " cannot be found in registered mappers.");
-    return mappers[name]->Create(parser, helper, block_id, op_id);
+    auto id = GetOpId(name);
+    Assert(id >= 0, name + " cannot be found in registered mappers.");
+    return generators[id]->Create(parser, helper, block_id, op_id);
+  }
+
+  // Prefer this one while converting, the mapper is constructed in the slot
+  // of its generator instead of heap
+  MapperHandle AcquireMapper(int32_t id, const PaddleParser& parser,
+                             OnnxHelper* helper, int64_t block_id,
+                             int64_t op_id) {
+    Assert(id >= 0 && id < static_cast<int32_t>(generators.size()),
+           "Invalid op id " + std::to_string(id) +
+               " while acquiring mapper.");
+    auto generator = generators[id];
+    return MapperHandle(generator,
+                        generator->Acquire(parser, helper, block_id, op_id));
+  }
+
+  MapperHandle AcquireMapper(const std::string& name,
+                             const PaddleParser& parser, OnnxHelper* helper,
+                             int64_t block_id, int64_t op_id) {
+    auto id = GetOpId(name);
+    Assert(id >= 0, name + " cannot be found in registered mappers.");
+    return AcquireMapper(id, parser, helper, block_id, op_id);
   }
 
   void Push(const std::string& name, Generator* generator) {
-    Assert(mappers.find(name) == mappers.end(),
+    Assert(op_ids.find(name) == op_ids.end(),
            name + " has been registered before.");
-    mappers[name] = generator;
+    op_ids[name] = static_cast<int32_t>(generators.size());
+    op_names.push_back(name);
+    generators.push_back(generator);
   }
 };
 }  // namespace paddle2onnx
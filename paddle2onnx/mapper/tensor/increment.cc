@@ -0,0 +1,27 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle2onnx/mapper/tensor/increment.h"
+
+namespace paddle2onnx {
+REGISTER_MAPPER(increment, IncrementMapper)
+
+void IncrementMapper::Opset7() {
+  auto x_info = GetInput("X");
+  auto out_info = GetOutput("Out");
+  auto step = helper_->Constant({1}, GetOnnxDtype(x_info[0].dtype), step_);
+  helper_->MakeNode("Add", {x_info[0].name, step}, {out_info[0].name});
+}
+
+}  // namespace paddle2onnx
@@ -22,109 +22,60 @@ namespace paddle2onnx {
 REGISTER_MAPPER(lookup_table, LookupTableMapper)
 REGISTER_MAPPER(lookup_table_v2, LookupTableMapper)
 
-int32_t LookupTableMapper::GetMinOpset(bool verbose) {
-  auto input_w_info = GetInput("W");
-  bool has_minus = false;
-  for (auto i : input_w_info[0].shape) {
-    has_minus = (i == -1);
-    if (has_minus) {
-      break;
-    }
-  }
-  if (padding_idx_ != -1 && has_minus) {
-    Logger(verbose, 11)
-        << "While the input W has dynamic shape and padding_idx != -1, "
-        << RequireOpset(11) << std::endl;
-    return 11;
+std::string LookupTableMapper::IdsNode() {
+  auto input_ids_info = GetInput("Ids");
+  auto ids_shape = input_ids_info[0].shape;
+  if (OpType() == "lookup_table" && ids_shape[ids_shape.size() - 1] == 1) {
+    return helper_->Squeeze(input_ids_info[0].name, {-1});
   }
-  return 7;
+  return input_ids_info[0].name;
 }
 
 void LookupTableMapper::Opset7() {
   auto input_ids_info = GetInput("Ids");
   auto input_w_info = GetInput("W");
   auto output_info = GetOutput("Out");
+  std::string ids_node = IdsNode();
 
-  std::string ids_node = input_ids_info[0].name;
-  auto ids_shape = input_ids_info[0].shape;
-  if (OpType() == "lookup_table" && ids_shape[ids_shape.size() - 1] == 1) {
-    ids_node = helper_->Squeeze(input_ids_info[0].name, {-1});
-  }
-
-  auto input_shape = input_w_info[0].shape;
-  int64_t sum_val = 1;
-  for (auto i : input_shape) {
-    sum_val *= i;
-  }
-  int interval = sum_val / input_shape[0];
-
-  if (padding_idx_ != -1) {
-    std::vector<int64_t> data(sum_val, 1);
-    for (auto i = 0; i < interval; i++) {
-      data[padding_idx_ * interval + i] = 0;
-    }
-    std::string constant = helper_->Constant(
-        input_shape, GetOnnxDtype(input_w_info[0].dtype), data);
-    auto weight_node =
-        helper_->MakeNode("Mul", {input_w_info[0].name, constant});
-    helper_->MakeNode("Gather", {weight_node->output(0), ids_node},
-                      {output_info[0].name});
-  } else {
+  // The row of padding_idx in parameter W is zeroed by the parser if W is
+  // only read by the lookup_table operators with the same padding_idx
+  if (padding_idx_ == -1 ||
+      parser_->IsZeroPaddingParam(input_w_info[0].name)) {
     helper_->MakeNode("Gather", {input_w_info[0].name, ids_node},
                       {output_info[0].name});
+    return;
   }
-}
 
-void LookupTableMapper::Opset11() {
-  auto input_ids_info = GetInput("Ids");
-  auto input_w_info = GetInput("W");
-  auto output_info = GetOutput("Out");
-
-  std::string ids_node = input_ids_info[0].name;
-  auto ids_shape = input_ids_info[0].shape;
-  if (OpType() == "lookup_table" && ids_shape[ids_shape.size() - 1] == 1) {
-    ids_node = helper_->Squeeze(input_ids_info[0].name, {-1});
+  // Replace the gathered rows of padding_idx with zeros
+  auto gather_node =
+      helper_->MakeNode("Gather", {input_w_info[0].name, ids_node});
+  std::string padding_idx =
+      helper_->Constant({}, ONNX_NAMESPACE::TensorProto::INT64, padding_idx_);
+  if (input_ids_info[0].dtype != P2ODataType::INT64) {
+    padding_idx = helper_->AutoCast(padding_idx, P2ODataType::INT64,
+                                    input_ids_info[0].dtype);
   }
-
-  auto input_shape = input_w_info[0].shape;
-  int64_t sum_val = 1;
-  for (auto i : input_shape) {
-    sum_val *= i;
+  auto equal_node = helper_->MakeNode("Equal", {ids_node, padding_idx});
+  // Negative axes of Unsqueeze are not supported before opset 11
+  int64_t ids_rank = input_ids_info[0].Rank();
+  if (ids_node != input_ids_info[0].name) {
+    ids_rank -= 1;
   }
-  int interval = sum_val / input_shape[0];
-
-  if (padding_idx_ != -1) {
-    bool has_minus = false;
-    for (auto i : input_w_info[0].shape) {
-      has_minus = (i == -1);
-      if (has_minus) {
-        break;
-      }
-    }
-    if (has_minus) {
-      std::vector<int64_t> shape = {interval};
-      std::string replace_data =
-          helper_->Constant(shape, GetOnnxDtype(input_w_info[0].dtype), 0.0);
-      std::string index = helper_->Constant(
-          {1}, ONNX_NAMESPACE::TensorProto::INT64, padding_idx_);
-      auto scatter_node = helper_->MakeNode(
-          "ScatterND", {input_w_info[0].name, index, replace_data});
-      helper_->MakeNode("Gather", {scatter_node->output(0), ids_node},
-                        {output_info[0].name});
-    } else {
-      std::vector<int64_t> data(sum_val, 1);
-      for (auto i = 0; i < interval; i++) {
-        data[padding_idx_ * interval + i] = 0;
-      }
-      std::string constant = helper_->Constant(
-          input_shape, GetOnnxDtype(input_w_info[0].dtype), data);
-      auto weight_node =
-          helper_->MakeNode("Mul", {input_w_info[0].name, constant});
-      helper_->MakeNode("Gather", {weight_node->output(0), ids_node},
-                        {output_info[0].name});
+  std::string is_padding =
+      helper_->Unsqueeze(equal_node->output(0), {ids_rank});
+  if (helper_->GetOpsetVersion() >= 9) {
+    std::string zero =
+        helper_->Constant({}, ONNX_NAMESPACE::TensorProto::FLOAT, 0.0);
+    if (input_w_info[0].dtype != P2ODataType::FP32) {
+      zero = helper_->AutoCast(zero, P2ODataType::FP32, input_w_info[0].dtype);
     }
+    helper_->MakeNode("Where", {is_padding, zero, gather_node->output(0)},
+                      {output_info[0].name});
   } else {
-    helper_->MakeNode("Gather", {input_w_info[0].name, ids_node},
+    auto not_node = helper_->MakeNode("Not", {is_padding});
+    std::string mask = helper_->AutoCast(
+        not_node->output(0), P2ODataType::BOOL, input_w_info[0].dtype);
+    helper_->MakeNode("Mul", {gather_node->output(0), mask},
                       {output_info[0].name});
   }
 }
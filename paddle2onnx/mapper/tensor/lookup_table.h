@@ -28,11 +28,10 @@ class LookupTableMapper : public Mapper {
     GetAttr("padding_idx", &padding_idx_);
   }
 
-  int32_t GetMinOpset(bool verbose = false);
   void Opset7();
-  void Opset11();
 
  private:
+  std::string IdsNode();
   int64_t padding_idx_;
 };
 
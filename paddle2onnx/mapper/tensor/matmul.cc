@@ -31,7 +31,86 @@ std::string MatmulMapper::GetTrans(std::vector<TensorInfo>& input_info) {
   return transpose_node->output(0);
 }
 
+bool ConstantWeightMatmul(Mapper* mapper, bool trans_x, bool trans_y,
+                          float alpha) {
+  auto helper = mapper->helper_;
+  auto input_x_info = mapper->GetInput("X");
+  auto input_y_info = mapper->GetInput("Y");
+  auto output_info = mapper->GetOutput("Out");
+  auto weight = mapper->GetParameter("Y");
+  if (weight == nullptr || weight->shape.size() < 2 ||
+      input_x_info[0].dtype != P2ODataType::FP32 ||
+      input_y_info[0].dtype != P2ODataType::FP32) {
+    return false;
+  }
+  int64_t rank = weight->shape.size();
+  // The input C of Gemm is optional since opset 11
+  bool use_gemm = rank == 2 && input_x_info[0].Rank() == 2 &&
+                  helper->GetOpsetVersion() >= 11;
+  // The parameter read by other operators is not rewritten, otherwise both of
+  // the original and rewritten weights are exported, Gemm transposes and
+  // scales it while running instead
+  bool rewrite_y = trans_y || fabs(alpha - 1.0) > 1e-6;
+  bool host_rewrite = rewrite_y && mapper->IsExclusiveParameterInput("Y");
+  if (rewrite_y && !host_rewrite && !use_gemm) {
+    return false;
+  }
+  std::string input_y = input_y_info[0].name;
+  if (host_rewrite) {
+    std::vector<float> data;
+    if (!mapper->TryGetParameterValue("Y", &data)) {
+      return false;
+    }
+    std::vector<int64_t> shape(weight->shape.begin(), weight->shape.end());
+    if (trans_y) {
+      int64_t rows = shape[rank - 2];
+      int64_t cols = shape[rank - 1];
+      std::vector<float> transposed(data.size());
+      for (size_t offset = 0; offset < data.size(); offset += rows * cols) {
+        for (int64_t i = 0; i < rows; ++i) {
+          for (int64_t j = 0; j < cols; ++j) {
+            transposed[offset + j * rows + i] = data[offset + i * cols + j];
+          }
+        }
+      }
+      data.swap(transposed);
+      std::swap(shape[rank - 2], shape[rank - 1]);
+    }
+    if (fabs(alpha - 1.0) > 1e-6) {
+      for (auto& item : data) {
+        item *= alpha;
+      }
+    }
+    input_y = helper->Assign(ONNX_NAMESPACE::TensorProto::FLOAT, shape, data);
+  }
+
+  std::string input_x = input_x_info[0].name;
+  if (trans_x) {
+    std::vector<int64_t> perm = Arange(0, input_x_info[0].Rank());
+    std::swap(perm[perm.size() - 1], perm[perm.size() - 2]);
+    auto transpose_node = helper->MakeNode("Transpose", {input_x});
+    AddAttribute(transpose_node, "perm", perm);
+    input_x = transpose_node->output(0);
+  }
+  if (use_gemm) {
+    auto gemm_node =
+        helper->MakeNode("Gemm", {input_x, input_y}, {output_info[0].name});
+    if (trans_y && !host_rewrite) {
+      AddAttribute(gemm_node, "transB", int64_t(1));
+    }
+    if (fabs(alpha - 1.0) > 1e-6 && !host_rewrite) {
+      AddAttribute(gemm_node, "alpha", alpha);
+    }
+  } else {
+    helper->MakeNode("MatMul", {input_x, input_y}, {output_info[0].name});
+  }
+  return true;
+}
+
 void MatmulMapper::Opset7() {
+  if (ConstantWeightMatmul(this, transpose_X_, transpose_Y_, alpha_)) {
+    return;
+  }
   auto input_x_info = GetInput("X");
   auto input_y_info = GetInput("Y");
   auto output_info = GetOutput("Out");
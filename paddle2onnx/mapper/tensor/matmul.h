@@ -20,6 +20,12 @@
 
 namespace paddle2onnx {
 
+// Export MatMul(Gemm for 2-D inputs) while the input Y of matmul/matmul_v2 is
+// a float32 parameter, Y is transposed and scaled by alpha while exporting if
+// it's only read by this operator, return false if it's not able to be handled
+bool ConstantWeightMatmul(Mapper* mapper, bool trans_x, bool trans_y,
+                          float alpha = 1.0);
+
 class MatmulMapper : public Mapper {
  public:
   MatmulMapper(const PaddleParser& p, OnnxHelper* helper, int64_t block_id,
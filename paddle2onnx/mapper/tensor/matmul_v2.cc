@@ -32,6 +32,9 @@ std::string MatmulV2Mapper::GetTrans(std::vector<TensorInfo>& input_info) {
 }
 
 void MatmulV2Mapper::Opset7() {
+  if (ConstantWeightMatmul(this, trans_x_, trans_y_)) {
+    return;
+  }
   auto input_x_info = GetInput("X");
   auto input_y_info = GetInput("Y");
   auto output_info = GetOutput("Out");
@@ -14,21 +14,26 @@
 
 #include "paddle2onnx/mapper/tensor/set_value.h"
 
+#include <algorithm>
+
 namespace paddle2onnx {
 REGISTER_MAPPER(set_value, SetValueMapper)
 
+// The limit of the constant indices of ScatterND computed while exporting
+const int64_t kMaxStaticIndicesNumel = 65536;
+
 int32_t SetValueMapper::GetMinOpset(bool verbose) {
   if (none_axes_.size() > 0) {
     Error() << "Attribute none_axes is not supported." << std::endl;
     return -1;
   }
-  if (axes_.size() > 1) {
-    Error() << "Attribute axes is supported while it only contains 1 element."
-            << std::endl;
-    return -1;
-  }
-  if (steps_.size() > 1) {
-    Error() << "ttribute steps is supported while it only contains 1 element."
+  std::vector<std::vector<int64_t>> indices;
+  if ((axes_.size() > 1 || steps_.size() > 1) &&
+      !GetStaticIndices(&indices)) {
+    Error() << "Attribute axes/steps with more than 1 element is only "
+               "supported while starts/ends/steps are constant, the shape "
+               "of input is static in the sliced dimensions and the number "
+               "of assigned elements is not too large."
             << std::endl;
     return -1;
   }
@@ -41,7 +46,156 @@ int32_t SetValueMapper::GetMinOpset(bool verbose) {
   return 12;
 }
 
+// Compute the indices to be assigned in dimensions [0, max(axes)] while the
+// starts/ends/steps are constant and these dimensions are static
+bool SetValueMapper::GetStaticIndices(
+    std::vector<std::vector<int64_t>>* indices) {
+  if (HasInput("StartsTensorList") || HasInput("EndsTensorList") ||
+      HasInput("StepsTensorList")) {
+    return false;
+  }
+  std::vector<int64_t> steps = steps_;
+  if (steps.empty()) {
+    steps.assign(axes_.size(), 1);
+  }
+  if (axes_.empty() || starts_.size() != axes_.size() ||
+      ends_.size() != axes_.size() || steps.size() != axes_.size()) {
+    return false;
+  }
+  auto input_info = GetInput("Input");
+  int64_t rank = input_info[0].Rank();
+  std::vector<int64_t> axes = axes_;
+  for (auto& axis : axes) {
+    axis = axis < 0 ? axis + rank : axis;
+    if (axis < 0 || axis >= rank) {
+      return false;
+    }
+  }
+  int64_t max_axis = *std::max_element(axes.begin(), axes.end());
+  indices->clear();
+  for (int64_t i = 0; i <= max_axis; ++i) {
+    if (input_info[0].shape[i] < 0) {
+      return false;
+    }
+    indices->push_back(Arange(0, input_info[0].shape[i]));
+  }
+  // Follow the slicing rule of python
+  for (size_t i = 0; i < axes.size(); ++i) {
+    int64_t dim = input_info[0].shape[axes[i]];
+    int64_t step = steps[i];
+    if (step == 0) {
+      return false;
+    }
+    int64_t lower = step > 0 ? 0 : -1;
+    int64_t upper = step > 0 ? dim : dim - 1;
+    int64_t start = starts_[i] < 0 ? starts_[i] + dim : starts_[i];
+    int64_t end = ends_[i] < 0 ? ends_[i] + dim : ends_[i];
+    start = std::min(std::max(start, lower), upper);
+    end = std::min(std::max(end, lower), upper);
+    std::vector<int64_t> axis_indices;
+    for (int64_t j = start; step > 0 ? j < end : j > end; j += step) {
+      axis_indices.push_back(j);
+    }
+    (*indices)[axes[i]] = axis_indices;
+  }
+  // Too large constant indices bloat the model, the runtime path is used
+  int64_t numel = indices->size();
+  for (auto& item : *indices) {
+    numel *= item.size();
+  }
+  return numel <= kMaxStaticIndicesNumel;
+}
+
+std::string SetValueMapper::GetValue(int64_t* value_rank) {
+  auto input_info = GetInput("Input");
+  auto output_info = GetOutput("Out");
+  std::string value = "";
+  *value_rank = input_info[0].Rank();
+  if (HasInput("ValueTensor")) {
+    auto value_info = GetInput("ValueTensor");
+    value = value_info[0].name;
+    *value_rank = value_info[0].Rank();
+  } else {
+    *value_rank = shape_.size();
+    int in_dtype = input_info[0].dtype;
+    if (in_dtype == P2ODataType::INT32 || in_dtype == P2ODataType::INT64) {
+      value = helper_->Assign(GetOnnxDtype(output_info[0].dtype), shape_,
+                              int_values_);
+    } else if (in_dtype == P2ODataType::FP32) {
+      value = helper_->Assign(GetOnnxDtype(output_info[0].dtype), shape_,
+                              fp32_values_);
+    } else if (in_dtype == P2ODataType::FP64) {
+      value = helper_->Assign(GetOnnxDtype(output_info[0].dtype), shape_,
+                              fp64_values_);
+    }
+  }
+  return value;
+}
+
+// The indices of ScatterND are computed while exporting, it's in shape of
+// [n_0, n_1, ..., n_k, k + 1] with k = max(axes)
+void SetValueMapper::StaticOpset12(
+    const std::vector<std::vector<int64_t>>& indices) {
+  auto input_info = GetInput("Input");
+  auto output_info = GetOutput("Out");
+  std::vector<int64_t> indices_shape;
+  int64_t numel = 1;
+  for (auto& item : indices) {
+    indices_shape.push_back(item.size());
+    numel *= item.size();
+  }
+  if (numel == 0) {
+    helper_->MakeNode("Identity", {input_info[0].name}, {output_info[0].name});
+    return;
+  }
+  indices_shape.push_back(indices.size());
+  std::vector<int64_t> indices_data;
+  indices_data.reserve(numel * indices.size());
+  std::vector<size_t> position(indices.size(), 0);
+  for (int64_t i = 0; i < numel; ++i) {
+    for (size_t j = 0; j < indices.size(); ++j) {
+      indices_data.push_back(indices[j][position[j]]);
+    }
+    for (int64_t j = indices.size() - 1; j >= 0; --j) {
+      if (++position[j] < indices[j].size()) {
+        break;
+      }
+      position[j] = 0;
+    }
+  }
+  auto scatter_indices = helper_->Constant(
+      indices_shape, ONNX_NAMESPACE::TensorProto::INT64, indices_data);
+
+  // The updates are in shape of [n_0, n_1, ..., n_k, d_{k+1}, ..., d_{r-1}]
+  indices_shape.pop_back();
+  auto updates_shape =
+      helper_->Constant(ONNX_NAMESPACE::TensorProto::INT64, indices_shape);
+  int64_t rank = input_info[0].Rank();
+  if (indices.size() < rank) {
+    auto input_shape =
+        helper_->MakeNode("Shape", {input_info[0].name})->output(0);
+    auto rest_shape =
+        helper_->Slice(input_shape, {0}, {int64_t(indices.size())}, {rank});
+    updates_shape = helper_->Concat({updates_shape, rest_shape}, 0);
+  }
+
+  int64_t value_rank = 0;
+  auto value = GetValue(&value_rank);
+  if (decrease_axes_.size() > 0 && value_rank != input_info[0].Rank()) {
+    value = helper_->Unsqueeze(value, decrease_axes_);
+  }
+  auto expand_value =
+      helper_->MakeNode("Expand", {value, updates_shape})->output(0);
+  helper_->MakeNode("ScatterND",
+                    {input_info[0].name, scatter_indices, expand_value},
+                    {output_info[0].name});
+}
+
 void SetValueMapper::Opset12() {
+  std::vector<std::vector<int64_t>> static_indices;
+  if (GetStaticIndices(&static_indices)) {
+    return StaticOpset12(static_indices);
+  }
   auto input_info = GetInput("Input");
   auto output_info = GetOutput("Out");
   std::string starts = "";
@@ -75,26 +229,8 @@ void SetValueMapper::Opset12() {
   } else {
     steps = helper_->Constant(ONNX_NAMESPACE::TensorProto::INT64, steps_);
   }
-  std::string value = "";
-  int64_t value_rank = input_info[0].Rank();
-  if (HasInput("ValueTensor")) {
-    auto value_info = GetInput("ValueTensor");
-    value = value_info[0].name;
-    value_rank = value_info[0].Rank();
-  } else {
-    value_rank = shape_.size();
-    int in_dtype = input_info[0].dtype;
-    if (in_dtype == P2ODataType::INT32 || in_dtype == P2ODataType::INT64) {
-      value = helper_->Assign(GetOnnxDtype(output_info[0].dtype), shape_,
-                              int_values_);
-    } else if (in_dtype == P2ODataType::FP32) {
-      value = helper_->Assign(GetOnnxDtype(output_info[0].dtype), shape_,
-                              fp32_values_);
-    } else if (in_dtype == P2ODataType::FP64) {
-      value = helper_->Assign(GetOnnxDtype(output_info[0].dtype), shape_,
-                              fp64_values_);
-    }
-  }
+  int64_t value_rank = 0;
+  std::string value = GetValue(&value_rank);
 
   auto sliced_data =
       helper_->MakeNode("Slice", {input_tensor, starts, ends, axes, steps})
@@ -50,6 +50,10 @@ class SetValueMapper : public Mapper {
   void Opset12();
 
  private:
+  bool GetStaticIndices(std::vector<std::vector<int64_t>>* indices);
+  std::string GetValue(int64_t* value_rank);
+  void StaticOpset12(const std::vector<std::vector<int64_t>>& indices);
+
   std::vector<int64_t> axes_;
   std::vector<int64_t> starts_;
   std::vector<int64_t> ends_;
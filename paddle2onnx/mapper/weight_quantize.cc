@@ -0,0 +1,377 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <regex>
+
+#include "paddle2onnx/mapper/exporter.h"
+
+namespace paddle2onnx {
+
+// The block size of MatMulNBits, the weights are quantized by blocks of
+// 32 elements along K
+const int64_t kInt4BlockSize = 32;
+
+static std::vector<float> GetFloatData(
+    const ONNX_NAMESPACE::TensorProto& tensor) {
+  std::vector<float> data;
+  if (tensor.has_raw_data()) {
+    data.resize(tensor.raw_data().size() / sizeof(float));
+    std::memcpy(data.data(), tensor.raw_data().data(),
+                data.size() * sizeof(float));
+  } else {
+    data.assign(tensor.float_data().begin(), tensor.float_data().end());
+  }
+  return data;
+}
+
+// The axis of per-channel scales, which is the output channel of the
+// consumer
+static int64_t GetQuantizeAxis(const ONNX_NAMESPACE::NodeProto& consumer,
+                               int32_t input_index, int64_t rank) {
+  if (consumer.op_type() == "MatMul" && input_index == 1) {
+    return rank - 1;
+  }
+  if (consumer.op_type() == "Gemm" && input_index == 1) {
+    for (auto& attr : consumer.attribute()) {
+      if (attr.name() == "transB" && attr.i() != 0) {
+        return 0;
+      }
+    }
+    return 1;
+  }
+  // The output channel of Conv and the rows of embedding table for Gather
+  return 0;
+}
+
+// Whether the weight used by `input_index` of the consumer can be computed by
+// MatMulNBits, `trans` is true if the weight is in layout of [N, K]
+static bool IsNBitsConsumer(const ONNX_NAMESPACE::NodeProto& consumer,
+                            int32_t input_index, bool* trans) {
+  *trans = false;
+  if (input_index != 1) {
+    return false;
+  }
+  if (consumer.op_type() == "MatMul") {
+    return true;
+  }
+  if (consumer.op_type() != "Gemm") {
+    return false;
+  }
+  for (auto& attr : consumer.attribute()) {
+    if (attr.name() == "transB") {
+      *trans = attr.i() != 0;
+    } else if ((attr.name() == "transA" && attr.i() != 0) ||
+               ((attr.name() == "alpha" || attr.name() == "beta") &&
+                attr.f() != 1.0)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Quantize the weight to int8 with symmetric scales, the weight is replaced
+// by DequantizeLinear with the same output name, axis < 0 means per-tensor
+static void QuantizeToInt8(
+    const std::string& name, const std::vector<int64_t>& dims,
+    const std::vector<float>& data, int64_t axis,
+    std::vector<ONNX_NAMESPACE::NodeProto>* nodes) {
+  int64_t channels = 1;
+  int64_t inner_size = static_cast<int64_t>(data.size());
+  if (axis >= 0) {
+    channels = dims[axis];
+    inner_size = 1;
+    for (size_t i = axis + 1; i < dims.size(); ++i) {
+      inner_size *= dims[i];
+    }
+  }
+  std::vector<float> scales(channels, 0.0);
+  for (size_t i = 0; i < data.size(); ++i) {
+    auto& scale = scales[(i / inner_size) % channels];
+    scale = std::max(scale, std::fabs(data[i]));
+  }
+  for (auto& scale : scales) {
+    scale = scale > 0 ? scale / 127 : 1.0;
+  }
+  std::vector<int8_t> quantized(data.size());
+  for (size_t i = 0; i < data.size(); ++i) {
+    float scale = scales[(i / inner_size) % channels];
+    float value = std::nearbyint(data[i] / scale);
+    quantized[i] =
+        static_cast<int8_t>(std::min(std::max(value, -127.f), 127.f));
+  }
+
+  std::vector<int64_t> scale_shape;
+  if (axis >= 0) {
+    scale_shape.push_back(channels);
+  }
+  Weight weight;
+  weight.set(P2ODataType::INT8, dims, quantized);
+  auto weight_name = MapperHelper::Get()->GenName("quantize.weight");
+  nodes->push_back(*MakeConstant(weight_name, weight));
+  weight.set(P2ODataType::FP32, scale_shape, scales);
+  auto scale_name = MapperHelper::Get()->GenName("quantize.scale");
+  nodes->push_back(*MakeConstant(scale_name, weight));
+  weight.set(P2ODataType::INT8, scale_shape,
+             std::vector<int8_t>(channels, 0));
+  auto zero_point_name =
+      MapperHelper::Get()->GenName("quantize.zero_point");
+  nodes->push_back(*MakeConstant(zero_point_name, weight));
+
+  auto node = std::make_shared<ONNX_NAMESPACE::NodeProto>();
+  node->set_name(MapperHelper::Get()->GenName("DequantizeLinear"));
+  node->set_op_type("DequantizeLinear");
+  node->add_input(weight_name);
+  node->add_input(scale_name);
+  node->add_input(zero_point_name);
+  node->add_output(name);
+  if (axis >= 0) {
+    AddAttribute(node, "axis", axis);
+  }
+  nodes->push_back(*node);
+}
+
+// Quantize the weight [K, N] of MatMul to the packed uint4 blocks of
+// MatMulNBits, the scales are symmetric and the zero point is default 8,
+// return the names of the packed weight and scales
+static std::pair<std::string, std::string> QuantizeToInt4(
+    const std::vector<int64_t>& dims, const std::vector<float>& data,
+    std::vector<ONNX_NAMESPACE::NodeProto>* nodes) {
+  int64_t k = dims[0];
+  int64_t n = dims[1];
+  int64_t blocks = (k + kInt4BlockSize - 1) / kInt4BlockSize;
+  int64_t blob_size = kInt4BlockSize / 2;
+  std::vector<uint8_t> packed(n * blocks * blob_size, 0);
+  std::vector<float> scales(n * blocks, 1.0);
+  for (int64_t col = 0; col < n; ++col) {
+    for (int64_t block = 0; block < blocks; ++block) {
+      int64_t begin = block * kInt4BlockSize;
+      int64_t end = std::min(begin + kInt4BlockSize, k);
+      float abs_max = 0.0;
+      for (int64_t row = begin; row < end; ++row) {
+        abs_max = std::max(abs_max, std::fabs(data[row * n + col]));
+      }
+      float scale = abs_max > 0 ? abs_max / 7 : 1.0;
+      scales[col * blocks + block] = scale;
+      uint8_t* blob = &packed[(col * blocks + block) * blob_size];
+      for (int64_t row = begin; row < begin + kInt4BlockSize; ++row) {
+        int32_t value = 8;
+        if (row < end) {
+          float q = std::nearbyint(data[row * n + col] / scale);
+          value = static_cast<int32_t>(std::min(std::max(q, -8.f), 7.f)) + 8;
+        }
+        int64_t offset = row - begin;
+        blob[offset / 2] |= offset % 2 == 0 ? value : value << 4;
+      }
+    }
+  }
+
+  Weight weight;
+  weight.set(P2ODataType::UINT8, {n, blocks, blob_size}, packed);
+  auto weight_name = MapperHelper::Get()->GenName("quantize.weight");
+  nodes->push_back(*MakeConstant(weight_name, weight));
+  weight.set(P2ODataType::FP32, {n * blocks}, scales);
+  auto scale_name = MapperHelper::Get()->GenName("quantize.scale");
+  nodes->push_back(*MakeConstant(scale_name, weight));
+  return std::make_pair(weight_name, scale_name);
+}
+
+void ModelExporter::QuantizeWeights(ONNX_NAMESPACE::ModelProto* model,
+                                    const std::string& quantize_type,
+                                    int64_t threshold,
+                                    const std::string& pattern,
+                                    bool verbose) {
+  int32_t opset_version = _helper.GetOpsetVersion();
+  if (opset_version < 10) {
+    P2OLogger() << "[WARN] Weight quantization requires opset_version >= 10, "
+                   "the weights are kept in float32."
+                << std::endl;
+    return;
+  }
+  bool use_nbits = quantize_type == "int4" && _helper.IsOnnxRuntimeTarget();
+  if (quantize_type == "int4" && !use_nbits) {
+    P2OLogger() << "[WARN] The int4 weights are only supported while "
+                   "target_profile is onnxruntime-cpu, the weights are "
+                   "quantized to int8 instead."
+                << std::endl;
+  }
+  std::regex name_pattern;
+  try {
+    name_pattern = std::regex(pattern);
+  } catch (const std::regex_error&) {
+    Assert(false, "Invalid weight_quantize_pattern: " + pattern + ".");
+  }
+
+  auto graph = model->mutable_graph();
+  std::set<std::string> subgraph_inputs;
+  std::map<std::string, std::vector<std::pair<int, int>>> consumers;
+  for (auto i = 0; i < graph->node_size(); ++i) {
+    auto& node = graph->node(i);
+    CollectSubgraphInputs(node, &subgraph_inputs);
+    for (auto j = 0; j < node.input_size(); ++j) {
+      consumers[node.input(j)].push_back(std::make_pair(i, j));
+    }
+  }
+  std::set<std::string> graph_outputs;
+  for (auto& output : graph->output()) {
+    graph_outputs.insert(output.name());
+  }
+
+  auto is_selected = [&](const std::string& name,
+                         const ONNX_NAMESPACE::TensorProto& tensor) {
+    if (tensor.data_type() != ONNX_NAMESPACE::TensorProto::FLOAT ||
+        tensor.dims_size() == 0 || consumers[name].empty()) {
+      return false;
+    }
+    int64_t numel = 1;
+    for (auto& dim : tensor.dims()) {
+      numel *= dim;
+    }
+    if (numel < threshold) {
+      return false;
+    }
+    return pattern.empty() || std::regex_search(name, name_pattern);
+  };
+
+  // The MatMul/Gemm nodes replaced by MatMulNBits
+  std::map<int, std::vector<ONNX_NAMESPACE::NodeProto>> replaced_nodes;
+  // The outputs of MatMulNBits, which are not inferred without the schema of
+  // com.microsoft domain
+  std::vector<std::string> nbits_outputs;
+  int64_t quantized_num = 0;
+  auto quantize = [&](const std::string& name,
+                      const ONNX_NAMESPACE::TensorProto& tensor,
+                      std::vector<ONNX_NAMESPACE::NodeProto>* nodes) {
+    std::vector<int64_t> dims(tensor.dims().begin(), tensor.dims().end());
+    std::vector<float> data = GetFloatData(tensor);
+    auto& uses = consumers[name];
+    quantized_num += 1;
+    bool use_matmul = dims.size() == 2 &&
+                      subgraph_inputs.find(name) == subgraph_inputs.end() &&
+                      graph_outputs.find(name) == graph_outputs.end();
+    bool trans = false;
+    for (size_t i = 0; i < uses.size() && use_matmul; ++i) {
+      bool use_trans = false;
+      use_matmul = IsNBitsConsumer(graph->node(uses[i].first), uses[i].second,
+                                   &use_trans) &&
+                   (i == 0 || use_trans == trans);
+      trans = use_trans;
+    }
+    if (use_nbits && use_matmul) {
+      if (trans) {
+        std::vector<float> transposed(data.size());
+        for (int64_t i = 0; i < dims[0]; ++i) {
+          for (int64_t j = 0; j < dims[1]; ++j) {
+            transposed[j * dims[0] + i] = data[i * dims[1] + j];
+          }
+        }
+        data.swap(transposed);
+        std::swap(dims[0], dims[1]);
+      }
+      auto names = QuantizeToInt4(dims, data, nodes);
+      for (auto& use : uses) {
+        auto& matmul = graph->node(use.first);
+        auto node = std::make_shared<ONNX_NAMESPACE::NodeProto>();
+        node->set_name(matmul.name());
+        node->set_op_type("MatMulNBits");
+        node->set_domain("com.microsoft");
+        node->add_input(matmul.input(0));
+        node->add_input(names.first);
+        node->add_input(names.second);
+        node->add_output(matmul.output(0));
+        AddAttribute(node, "K", dims[0]);
+        AddAttribute(node, "N", dims[1]);
+        AddAttribute(node, "bits", int64_t(4));
+        AddAttribute(node, "block_size", kInt4BlockSize);
+        replaced_nodes[use.first].push_back(*node);
+        // The bias of Gemm
+        if (matmul.input_size() > 2 && !matmul.input(2).empty()) {
+          auto matmul_output = MapperHelper::Get()->GenName("MatMulNBits");
+          replaced_nodes[use.first].back().set_output(0, matmul_output);
+          auto add = std::make_shared<ONNX_NAMESPACE::NodeProto>();
+          add->set_name(MapperHelper::Get()->GenName("Add"));
+          add->set_op_type("Add");
+          add->add_input(matmul_output);
+          add->add_input(matmul.input(2));
+          add->add_output(matmul.output(0));
+          replaced_nodes[use.first].push_back(*add);
+        }
+        auto& output = replaced_nodes[use.first].front().output(0);
+        if (graph_outputs.find(output) == graph_outputs.end()) {
+          nbits_outputs.push_back(output);
+        }
+      }
+      return;
+    }
+    // Per-channel DequantizeLinear is supported since opset 13
+    int64_t axis = -1;
+    if (opset_version >= 13 && dims.size() > 1) {
+      axis = GetQuantizeAxis(graph->node(uses[0].first), uses[0].second,
+                             dims.size());
+    }
+    QuantizeToInt8(name, dims, data, axis, nodes);
+  };
+
+  std::vector<ONNX_NAMESPACE::NodeProto> nodes;
+  std::vector<ONNX_NAMESPACE::TensorProto> initializers;
+  for (auto& tensor : graph->initializer()) {
+    if (is_selected(tensor.name(), tensor)) {
+      quantize(tensor.name(), tensor, &nodes);
+    } else {
+      initializers.push_back(tensor);
+    }
+  }
+  for (auto i = 0; i < graph->node_size(); ++i) {
+    auto& node = graph->node(i);
+    if (node.op_type() == "Constant" && node.attribute_size() == 1 &&
+        node.attribute(0).has_t() &&
+        is_selected(node.output(0), node.attribute(0).t())) {
+      quantize(node.output(0), node.attribute(0).t(), &nodes);
+      continue;
+    }
+    auto iter = replaced_nodes.find(i);
+    if (iter == replaced_nodes.end()) {
+      nodes.push_back(node);
+    } else {
+      nodes.insert(nodes.end(), iter->second.begin(), iter->second.end());
+    }
+  }
+  if (quantized_num == 0) {
+    return;
+  }
+  P2OLogger(verbose) << "Quantized " << quantized_num << " weights to "
+                     << (use_nbits ? "int4/int8" : "int8") << "."
+                     << std::endl;
+
+  graph->clear_initializer();
+  for (auto& tensor : initializers) {
+    *(graph->add_initializer()) = tensor;
+  }
+  graph->clear_node();
+  for (auto& node : nodes) {
+    *(graph->add_node()) = node;
+  }
+  // The weights are not float32 tensors now
+  graph->clear_value_info();
+  for (auto& name : nbits_outputs) {
+    auto value_info = graph->add_value_info();
+    value_info->set_name(name);
+    value_info->mutable_type()->mutable_tensor_type()->set_elem_type(
+        ONNX_NAMESPACE::TensorProto::FLOAT);
+  }
+}
+
+}  // namespace paddle2onnx
@@ -0,0 +1,248 @@
+//   Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+// The NHWC operators are exported as Transpose + NCHW operator + Transpose,
+// this pass cancels the pair of transposes through the layout insensitive
+// operators(activation/elementwise ops)
+// Before:
+//   X1 = Transpose(A, perm=[0, 2, 3, 1])
+//   X2 = Transpose(B, perm=[0, 2, 3, 1])
+//   Y = Transpose(Relu(Add(X1, X2)), perm=[0, 3, 1, 2])
+// After:
+//   Y = Relu(Add(A, B))
+// The constant inputs of elementwise ops are transposed while exporting
+
+#include <algorithm>
+#include <numeric>
+#include <set>
+
+#include "onnx/defs/tensor_util.h"
+#include "onnxoptimizer/pass.h"
+
+namespace ONNX_NAMESPACE {
+namespace optimization {
+
+struct EliminateLayoutTranspose final : public PredicateBasedPass {
+  explicit EliminateLayoutTranspose()
+      : PredicateBasedPass(PassType::Nop, PassEfficiency::Complete,
+                           PassOptimizationType::Compute) {}
+  std::string getPassName() const override {
+    return "eliminate_layout_transpose";
+  }
+
+  bool patternMatchPredicate(Node* node) override {
+    return node->kind() == kTranspose && node->hasAttribute(kperm);
+  }
+
+  // Operators only use the first input as data, and the other inputs should
+  // be scalar constants
+  bool IsUnaryOp(Node* node) {
+    static const std::set<std::string> unary_ops = {
+        "Abs",       "Cast",     "Ceil",     "Clip",        "Cos",
+        "Elu",       "Erf",      "Exp",      "Floor",       "HardSigmoid",
+        "HardSwish", "Identity", "LeakyRelu", "Log",        "Neg",
+        "Reciprocal", "Relu",    "Round",    "Selu",        "Sigmoid",
+        "Sin",       "Softplus", "Softsign", "Sqrt",        "Tanh"};
+    return unary_ops.find(node->kind().toString()) != unary_ops.end();
+  }
+
+  bool IsBinaryOp(Node* node) {
+    static const std::set<std::string> binary_ops = {
+        "Add", "Sub", "Mul", "Div", "Max", "Min", "Pow"};
+    return binary_ops.find(node->kind().toString()) != binary_ops.end();
+  }
+
+  static bool IsScalarConstant(Value* value) {
+    if (value->node()->kind() != kConstant ||
+        !value->node()->hasAttribute(kvalue)) {
+      return false;
+    }
+    const auto& sizes = value->node()->t(kvalue).sizes();
+    return std::accumulate(sizes.begin(), sizes.end(), int64_t(1),
+                           std::multiplies<int64_t>()) == 1;
+  }
+
+  struct Rewrite {
+    // Transposes to be removed at the beginning of the chain
+    std::vector<Node*> transposes;
+    // Nodes between the transposes, their output layout will be changed
+    std::vector<Node*> nodes;
+    // Constant inputs need to be transposed, (node, input index)
+    std::vector<std::pair<Node*, size_t>> constants;
+  };
+
+  // Search backward from `value` until reaching the transposes with
+  // `inverse_perm`, all the values on the path should be used only once
+  bool Collect(Value* value, const std::vector<int64_t>& inverse_perm,
+               Rewrite* rewrite) {
+    if (value->uses().size() != 1) {
+      return false;
+    }
+    Node* node = value->node();
+    if (node->kind() == kTranspose) {
+      if (!node->hasAttribute(kperm) || node->is(kperm) != inverse_perm) {
+        return false;
+      }
+      rewrite->transposes.push_back(node);
+      return true;
+    }
+    if (node->outputs().size() != 1) {
+      return false;
+    }
+    if (IsUnaryOp(node)) {
+      for (size_t i = 1; i < node->inputs().size(); ++i) {
+        if (node->inputs()[i]->node()->kind() != kUndefined &&
+            !IsScalarConstant(node->inputs()[i])) {
+          return false;
+        }
+      }
+      rewrite->nodes.push_back(node);
+      return Collect(node->inputs()[0], inverse_perm, rewrite);
+    }
+    if (IsBinaryOp(node) && node->inputs().size() == 2) {
+      rewrite->nodes.push_back(node);
+      bool has_data = false;
+      for (size_t i = 0; i < 2; ++i) {
+        Value* input = node->inputs()[i];
+        if (input->node()->kind() == kConstant) {
+          if (!IsScalarConstant(input)) {
+            const Tensor& t = input->node()->t(kvalue);
+            if (t.elem_type() != TensorProto_DataType_FLOAT ||
+                t.sizes().size() > inverse_perm.size()) {
+              return false;
+            }
+            rewrite->constants.push_back(std::make_pair(node, i));
+          }
+          continue;
+        }
+        if (!Collect(input, inverse_perm, rewrite)) {
+          return false;
+        }
+        has_data = true;
+      }
+      return has_data;
+    }
+    return false;
+  }
+
+  // Transpose the constant with perm, the constant will be broadcasted to
+  // rank of perm first
+  static Tensor TransposeConstant(const Tensor& tensor,
+                                  const std::vector<int64_t>& perm) {
+    std::vector<int64_t> shape(perm.size() - tensor.sizes().size(), 1);
+    shape.insert(shape.end(), tensor.sizes().begin(), tensor.sizes().end());
+    Tensor t = tensor;
+    std::vector<float> data = ParseData<float>(&t);
+
+    size_t rank = perm.size();
+    std::vector<int64_t> strides(rank, 1);
+    for (int64_t i = rank - 2; i >= 0; --i) {
+      strides[i] = strides[i + 1] * shape[i + 1];
+    }
+    std::vector<int64_t> out_shape(rank);
+    for (size_t i = 0; i < rank; ++i) {
+      out_shape[i] = shape[perm[i]];
+    }
+    std::vector<float> out(data.size());
+    std::vector<int64_t> index(rank, 0);
+    for (size_t i = 0; i < out.size(); ++i) {
+      int64_t offset = 0;
+      for (size_t j = 0; j < rank; ++j) {
+        offset += index[j] * strides[perm[j]];
+      }
+      out[i] = data[offset];
+      for (int64_t j = rank - 1; j >= 0; --j) {
+        if (++index[j] < out_shape[j]) {
+          break;
+        }
+        index[j] = 0;
+      }
+    }
+
+    Tensor result;
+    result.elem_type() = TensorProto_DataType_FLOAT;
+    result.sizes() = out_shape;
+    result.floats() = std::move(out);
+    return result;
+  }
+
+  bool runTransform(Node* n, Graph& graph,
+                    NodeDestroyType& destroy_current) override {
+    destroy_current = NodeDestroyType::DestroyZero;
+    std::vector<int64_t> perm = n->is(kperm);
+    std::vector<int64_t> inverse_perm(perm.size());
+    for (size_t i = 0; i < perm.size(); ++i) {
+      if (perm[i] < 0 || perm[i] >= perm.size()) {
+        return false;
+      }
+      inverse_perm[perm[i]] = i;
+    }
+
+    Rewrite rewrite;
+    if (!Collect(n->inputs()[0], inverse_perm, &rewrite)) {
+      return false;
+    }
+    // Transpose(Transpose(X)) while X is graph input and the result is graph
+    // output cannot be removed
+    const auto& outputs = graph.outputs();
+    if (rewrite.nodes.empty() &&
+        std::find(outputs.rbegin(), outputs.rend(), n->output()) !=
+            outputs.rend()) {
+      return false;
+    }
+
+    for (auto& item : rewrite.constants) {
+      Node* node = item.first;
+      Value* input = node->inputs()[item.second];
+      Tensor t = TransposeConstant(input->node()->t(kvalue), perm);
+      Node* constant = graph.create(kConstant, 1);
+      constant->insertBefore(node);
+      std::vector<Dimension> dims(t.sizes().begin(), t.sizes().end());
+      constant->output()->setSizes(dims);
+      constant->output()->setElemType(TensorProto_DataType_FLOAT);
+      constant->t_(kvalue, std::move(t));
+      node->replaceInput(item.second, constant->output());
+    }
+    for (auto& node : rewrite.nodes) {
+      Value* output = node->output();
+      // The layout is changed, so the name of the variable in PaddlePaddle
+      // program with the other layout should not be used
+      output->setUniqueName(graph.getNextUniqueName());
+      if (output->has_sizes() && output->sizes().size() == perm.size()) {
+        std::vector<Dimension> sizes;
+        for (size_t i = 0; i < perm.size(); ++i) {
+          sizes.push_back(output->sizes()[perm[i]]);
+        }
+        output->setSizes(sizes);
+      }
+    }
+    for (auto& transpose : rewrite.transposes) {
+      transpose->output()->replaceAllUsesWith(transpose->inputs()[0]);
+    }
+    if (!tryReplacingAllUsesWith(n->output(), n->inputs()[0])) {
+      return false;
+    }
+    destroy_current = NodeDestroyType::DestroyOne;
+    return true;
+  }
+};
+
+}  // namespace optimization
+}  // namespace ONNX_NAMESPACE
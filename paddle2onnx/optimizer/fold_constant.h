@@ -0,0 +1,812 @@
+//   Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+// Evaluate the operators whose inputs are all constants while exporting
+// Before:
+//   Y = Concat(Shape(X), Constant)  (X is in static shape)
+// After:
+//   Y = Constant
+// Only the common shape manipulation and elementwise operators are supported,
+// and the results larger than kMaxElements are kept as operators to avoid
+// bloating the model
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <vector>
+
+#include "onnx/defs/tensor_util.h"
+#include "onnxoptimizer/pass.h"
+
+namespace ONNX_NAMESPACE {
+namespace optimization {
+
+struct FoldConstant final : public PredicateBasedPass {
+  explicit FoldConstant()
+      : PredicateBasedPass(PassType::Fuse, PassEfficiency::Complete,
+                           PassOptimizationType::Compute) {}
+  std::string getPassName() const override { return "fold_constant"; }
+
+  static const int64_t kMaxElements = 65536;
+
+  // Data of the constant tensor, the integers and booleans are stored in
+  // `ints`, the floating points are stored in `floats`
+  struct Data {
+    int32_t elem_type = TensorProto_DataType_UNDEFINED;
+    std::vector<int64_t> sizes;
+    std::vector<int64_t> ints;
+    std::vector<double> floats;
+
+    bool IsFloat() const {
+      return elem_type == TensorProto_DataType_FLOAT ||
+             elem_type == TensorProto_DataType_DOUBLE;
+    }
+    bool Defined() const {
+      return elem_type != TensorProto_DataType_UNDEFINED;
+    }
+  };
+
+  static bool IsSupported(int32_t elem_type) {
+    return elem_type == TensorProto_DataType_FLOAT ||
+           elem_type == TensorProto_DataType_DOUBLE ||
+           elem_type == TensorProto_DataType_INT32 ||
+           elem_type == TensorProto_DataType_INT64 ||
+           elem_type == TensorProto_DataType_BOOL;
+  }
+
+  // Return -1 if the number of elements exceeds kMaxElements
+  static int64_t Numel(const std::vector<int64_t>& sizes) {
+    int64_t numel = 1;
+    for (auto& size : sizes) {
+      if (size < 0 || (size > 0 && numel > kMaxElements / size)) {
+        return -1;
+      }
+      numel *= size;
+    }
+    return numel > kMaxElements ? -1 : numel;
+  }
+
+  static std::vector<int64_t> Strides(const std::vector<int64_t>& sizes) {
+    std::vector<int64_t> strides(sizes.size(), 1);
+    for (int64_t i = static_cast<int64_t>(sizes.size()) - 2; i >= 0; --i) {
+      strides[i] = strides[i + 1] * sizes[i + 1];
+    }
+    return strides;
+  }
+
+  // Move to the next index of tensor in shape of `sizes`
+  static void NextIndex(const std::vector<int64_t>& sizes,
+                        std::vector<int64_t>* index) {
+    for (int64_t i = static_cast<int64_t>(sizes.size()) - 1; i >= 0; --i) {
+      if (++(*index)[i] < sizes[i]) {
+        return;
+      }
+      (*index)[i] = 0;
+    }
+  }
+
+  static bool IsConstant(Value* value) {
+    return value->node()->kind() == kConstant &&
+           value->node()->hasAttribute(kvalue);
+  }
+
+  static bool Load(const Tensor& tensor, Data* data) {
+    Tensor t = tensor;
+    data->elem_type = t.elem_type();
+    data->sizes = t.sizes();
+    if (Numel(data->sizes) < 0) {
+      return false;
+    }
+    if (data->elem_type == TensorProto_DataType_FLOAT) {
+      std::vector<float> values = ParseData<float>(&t);
+      data->floats.assign(values.begin(), values.end());
+    } else if (data->elem_type == TensorProto_DataType_DOUBLE) {
+      data->floats = ParseData<double>(&t);
+    } else if (data->elem_type == TensorProto_DataType_INT64) {
+      data->ints = ParseData<int64_t>(&t);
+    } else if (data->elem_type == TensorProto_DataType_INT32 ||
+               (data->elem_type == TensorProto_DataType_BOOL &&
+                !t.is_raw_data())) {
+      std::vector<int32_t> values = ParseData<int32_t>(&t);
+      data->ints.assign(values.begin(), values.end());
+    } else if (data->elem_type == TensorProto_DataType_BOOL) {
+      // The booleans in raw data are stored in bytes
+      for (auto& c : t.raw()) {
+        data->ints.push_back(c != 0);
+      }
+    } else {
+      return false;
+    }
+    int64_t numel = data->IsFloat() ? data->floats.size() : data->ints.size();
+    return numel == Numel(data->sizes);
+  }
+
+  static Tensor Store(const Data& data) {
+    Tensor t;
+    t.elem_type() = data.elem_type;
+    t.sizes() = data.sizes;
+    if (data.elem_type == TensorProto_DataType_FLOAT) {
+      t.floats().assign(data.floats.begin(), data.floats.end());
+    } else if (data.elem_type == TensorProto_DataType_DOUBLE) {
+      t.doubles() = data.floats;
+    } else if (data.elem_type == TensorProto_DataType_INT64) {
+      t.int64s() = data.ints;
+    } else {
+      t.int32s().assign(data.ints.begin(), data.ints.end());
+    }
+    return t;
+  }
+
+  // Gather the elements of `in` by offsets into `out`
+  static void Select(const Data& in, const std::vector<int64_t>& offsets,
+                     Data* out) {
+    out->elem_type = in.elem_type;
+    for (auto& offset : offsets) {
+      if (in.IsFloat()) {
+        out->floats.push_back(in.floats[offset]);
+      } else {
+        out->ints.push_back(in.ints[offset]);
+      }
+    }
+  }
+
+  // Offsets of the elements of tensor in `in_sizes` while broadcasting to
+  // `out_sizes`
+  static std::vector<int64_t> BroadcastOffsets(
+      const std::vector<int64_t>& in_sizes,
+      const std::vector<int64_t>& out_sizes) {
+    std::vector<int64_t> strides = Strides(in_sizes);
+    size_t shift = out_sizes.size() - in_sizes.size();
+    std::vector<int64_t> offsets(Numel(out_sizes));
+    std::vector<int64_t> index(out_sizes.size(), 0);
+    for (auto& offset : offsets) {
+      offset = 0;
+      for (size_t i = 0; i < in_sizes.size(); ++i) {
+        if (in_sizes[i] != 1) {
+          offset += index[i + shift] * strides[i];
+        }
+      }
+      NextIndex(out_sizes, &index);
+    }
+    return offsets;
+  }
+
+  static bool BroadcastSizes(const std::vector<int64_t>& x,
+                             const std::vector<int64_t>& y,
+                             std::vector<int64_t>* out) {
+    out->assign(std::max(x.size(), y.size()), 1);
+    for (size_t i = 0; i < out->size(); ++i) {
+      int64_t a = i < x.size() ? x[x.size() - 1 - i] : 1;
+      int64_t b = i < y.size() ? y[y.size() - 1 - i] : 1;
+      if (a != b && a != 1 && b != 1) {
+        return false;
+      }
+      (*out)[out->size() - 1 - i] = a == 1 ? b : a;
+    }
+    return Numel(*out) >= 0;
+  }
+
+  static bool NormalizeAxis(int64_t rank, int64_t* axis) {
+    if (*axis < 0) {
+      *axis += rank;
+    }
+    return *axis >= 0 && *axis < rank;
+  }
+
+  // Get the attribute `name` or the optional input `index` as integers
+  static bool GetInts(Node* n, const std::vector<Data>& inputs, Symbol name,
+                      size_t index, std::vector<int64_t>* values) {
+    if (n->hasAttribute(name)) {
+      *values = n->is(name);
+      return true;
+    }
+    if (index < inputs.size() && inputs[index].Defined()) {
+      if (inputs[index].IsFloat()) {
+        return false;
+      }
+      *values = inputs[index].ints;
+      return true;
+    }
+    return false;
+  }
+
+  bool FoldShape(Node* n, Data* out) {
+    Value* input = n->inputs()[0];
+    std::vector<int64_t> sizes;
+    if (IsConstant(input)) {
+      sizes = input->node()->t(kvalue).sizes();
+    } else {
+      if (!input->has_sizes()) {
+        return false;
+      }
+      for (auto& dim : input->sizes()) {
+        if (!dim.is_int || dim.dim < 0) {
+          return false;
+        }
+        sizes.push_back(dim.dim);
+      }
+    }
+    int64_t rank = sizes.size();
+    int64_t start = n->hasAttribute(Symbol("start")) ? n->i(Symbol("start"))
+                                                     : 0;
+    int64_t end = n->hasAttribute(Symbol("end")) ? n->i(Symbol("end")) : rank;
+    start = std::min(std::max(start < 0 ? start + rank : start, int64_t(0)),
+                     rank);
+    end = std::min(std::max(end < 0 ? end + rank : end, int64_t(0)), rank);
+    out->elem_type = TensorProto_DataType_INT64;
+    for (int64_t i = start; i < end; ++i) {
+      out->ints.push_back(sizes[i]);
+    }
+    out->sizes = {static_cast<int64_t>(out->ints.size())};
+    return true;
+  }
+
+  bool FoldCast(Node* n, const Data& x, Data* out) {
+    out->elem_type = n->i(kto);
+    out->sizes = x.sizes;
+    if (!IsSupported(out->elem_type)) {
+      return false;
+    }
+    if (out->IsFloat()) {
+      if (x.IsFloat()) {
+        out->floats = x.floats;
+      } else {
+        out->floats.assign(x.ints.begin(), x.ints.end());
+      }
+      if (out->elem_type == TensorProto_DataType_FLOAT) {
+        for (auto& value : out->floats) {
+          value = static_cast<float>(value);
+        }
+      }
+      return true;
+    }
+    if (x.IsFloat()) {
+      for (auto& value : x.floats) {
+        if (std::isnan(value) || std::isinf(value)) {
+          return false;
+        }
+        out->ints.push_back(out->elem_type == TensorProto_DataType_BOOL
+                                ? value != 0
+                                : static_cast<int64_t>(value));
+      }
+    } else {
+      out->ints = x.ints;
+    }
+    for (auto& value : out->ints) {
+      if (out->elem_type == TensorProto_DataType_BOOL) {
+        value = value != 0;
+      } else if (out->elem_type == TensorProto_DataType_INT32) {
+        value = static_cast<int32_t>(value);
+      }
+    }
+    return true;
+  }
+
+  bool FoldReshape(Node* n, const Data& x, const Data& shape, Data* out) {
+    if (!shape.Defined() || shape.IsFloat()) {
+      return false;
+    }
+    bool allowzero = n->hasAttribute(Symbol("allowzero")) &&
+                     n->i(Symbol("allowzero")) != 0;
+    *out = x;
+    out->sizes = shape.ints;
+    int64_t unknown_index = -1;
+    int64_t known = 1;
+    for (size_t i = 0; i < out->sizes.size(); ++i) {
+      if (out->sizes[i] == 0 && !allowzero) {
+        if (i >= x.sizes.size()) {
+          return false;
+        }
+        out->sizes[i] = x.sizes[i];
+      } else if (out->sizes[i] == -1) {
+        if (unknown_index >= 0) {
+          return false;
+        }
+        unknown_index = i;
+        continue;
+      } else if (out->sizes[i] < 0) {
+        return false;
+      }
+      known *= out->sizes[i];
+    }
+    int64_t numel = Numel(x.sizes);
+    if (unknown_index >= 0) {
+      if (known == 0 || numel % known != 0) {
+        return false;
+      }
+      out->sizes[unknown_index] = numel / known;
+    }
+    return Numel(out->sizes) == numel;
+  }
+
+  bool FoldUnsqueeze(Node* n, const std::vector<Data>& inputs, Data* out) {
+    std::vector<int64_t> axes;
+    if (!GetInts(n, inputs, kaxes, 1, &axes)) {
+      return false;
+    }
+    *out = inputs[0];
+    int64_t rank = inputs[0].sizes.size() + axes.size();
+    std::vector<bool> expanded(rank, false);
+    for (auto& axis : axes) {
+      if (!NormalizeAxis(rank, &axis) || expanded[axis]) {
+        return false;
+      }
+      expanded[axis] = true;
+    }
+    out->sizes.clear();
+    size_t j = 0;
+    for (int64_t i = 0; i < rank; ++i) {
+      out->sizes.push_back(expanded[i] ? 1 : inputs[0].sizes[j++]);
+    }
+    return true;
+  }
+
+  bool FoldSqueeze(Node* n, const std::vector<Data>& inputs, Data* out) {
+    std::vector<int64_t> axes;
+    int64_t rank = inputs[0].sizes.size();
+    std::vector<bool> squeezed(rank, false);
+    if (GetInts(n, inputs, kaxes, 1, &axes)) {
+      for (auto& axis : axes) {
+        if (!NormalizeAxis(rank, &axis) || inputs[0].sizes[axis] != 1) {
+          return false;
+        }
+        squeezed[axis] = true;
+      }
+    } else {
+      for (int64_t i = 0; i < rank; ++i) {
+        squeezed[i] = inputs[0].sizes[i] == 1;
+      }
+    }
+    *out = inputs[0];
+    out->sizes.clear();
+    for (int64_t i = 0; i < rank; ++i) {
+      if (!squeezed[i]) {
+        out->sizes.push_back(inputs[0].sizes[i]);
+      }
+    }
+    return true;
+  }
+
+  bool FoldConcat(Node* n, const std::vector<Data>& inputs, Data* out) {
+    int64_t rank = inputs[0].sizes.size();
+    int64_t axis = n->i(kaxis);
+    if (!NormalizeAxis(rank, &axis)) {
+      return false;
+    }
+    out->elem_type = inputs[0].elem_type;
+    out->sizes = inputs[0].sizes;
+    out->sizes[axis] = 0;
+    for (auto& input : inputs) {
+      if (input.elem_type != out->elem_type ||
+          static_cast<int64_t>(input.sizes.size()) != rank) {
+        return false;
+      }
+      for (int64_t i = 0; i < rank; ++i) {
+        if (i != axis && input.sizes[i] != out->sizes[i]) {
+          return false;
+        }
+      }
+      out->sizes[axis] += input.sizes[axis];
+    }
+    if (Numel(out->sizes) < 0) {
+      return false;
+    }
+    int64_t outer = 1;
+    for (int64_t i = 0; i < axis; ++i) {
+      outer *= out->sizes[i];
+    }
+    for (int64_t i = 0; i < outer; ++i) {
+      for (auto& input : inputs) {
+        int64_t block = Numel(input.sizes) / outer;
+        if (input.IsFloat()) {
+          out->floats.insert(out->floats.end(),
+                             input.floats.begin() + i * block,
+                             input.floats.begin() + (i + 1) * block);
+        } else {
+          out->ints.insert(out->ints.end(), input.ints.begin() + i * block,
+                           input.ints.begin() + (i + 1) * block);
+        }
+      }
+    }
+    return true;
+  }
+
+  bool FoldGather(Node* n, const Data& x, const Data& indices, Data* out) {
+    int64_t rank = x.sizes.size();
+    int64_t axis = n->hasAttribute(kaxis) ? n->i(kaxis) : 0;
+    if (indices.IsFloat() || !NormalizeAxis(rank, &axis)) {
+      return false;
+    }
+    out->sizes.assign(x.sizes.begin(), x.sizes.begin() + axis);
+    out->sizes.insert(out->sizes.end(), indices.sizes.begin(),
+                      indices.sizes.end());
+    out->sizes.insert(out->sizes.end(), x.sizes.begin() + axis + 1,
+                      x.sizes.end());
+    if (Numel(out->sizes) < 0) {
+      return false;
+    }
+    int64_t outer = 1;
+    int64_t inner = 1;
+    for (int64_t i = 0; i < rank; ++i) {
+      if (i < axis) {
+        outer *= x.sizes[i];
+      } else if (i > axis) {
+        inner *= x.sizes[i];
+      }
+    }
+    std::vector<int64_t> offsets;
+    for (int64_t i = 0; i < outer; ++i) {
+      for (auto index : indices.ints) {
+        if (index < 0) {
+          index += x.sizes[axis];
+        }
+        if (index < 0 || index >= x.sizes[axis]) {
+          return false;
+        }
+        for (int64_t j = 0; j < inner; ++j) {
+          offsets.push_back((i * x.sizes[axis] + index) * inner + j);
+        }
+      }
+    }
+    Select(x, offsets, out);
+    return true;
+  }
+
+  bool FoldSlice(Node* n, const std::vector<Data>& inputs, Data* out) {
+    const Data& x = inputs[0];
+    int64_t rank = x.sizes.size();
+    std::vector<int64_t> starts;
+    std::vector<int64_t> ends;
+    std::vector<int64_t> axes;
+    std::vector<int64_t> steps;
+    if (!GetInts(n, inputs, kstarts, 1, &starts) ||
+        !GetInts(n, inputs, kends, 2, &ends) || starts.size() != ends.size()) {
+      return false;
+    }
+    if (!GetInts(n, inputs, kaxes, 3, &axes)) {
+      axes.resize(starts.size());
+      for (size_t i = 0; i < axes.size(); ++i) {
+        axes[i] = i;
+      }
+    }
+    if (!GetInts(n, inputs, Symbol("steps"), 4, &steps)) {
+      steps.assign(starts.size(), 1);
+    }
+    if (axes.size() != starts.size() || steps.size() != starts.size()) {
+      return false;
+    }
+    std::vector<int64_t> begin(rank, 0);
+    std::vector<int64_t> step(rank, 1);
+    out->sizes = x.sizes;
+    for (size_t i = 0; i < axes.size(); ++i) {
+      int64_t axis = axes[i];
+      if (!NormalizeAxis(rank, &axis) || steps[i] == 0) {
+        return false;
+      }
+      int64_t dim = x.sizes[axis];
+      int64_t start = starts[i] < 0 ? starts[i] + dim : starts[i];
+      int64_t end = ends[i] < 0 ? ends[i] + dim : ends[i];
+      if (steps[i] > 0) {
+        start = std::min(std::max(start, int64_t(0)), dim);
+        end = std::min(std::max(end, int64_t(0)), dim);
+        out->sizes[axis] =
+            end > start ? (end - start + steps[i] - 1) / steps[i] : 0;
+      } else {
+        start = std::min(std::max(start, int64_t(0)), dim - 1);
+        end = std::min(std::max(end, int64_t(-1)), dim - 1);
+        out->sizes[axis] =
+            start > end ? (start - end - steps[i] - 1) / -steps[i] : 0;
+      }
+      begin[axis] = start;
+      step[axis] = steps[i];
+    }
+    std::vector<int64_t> strides = Strides(x.sizes);
+    std::vector<int64_t> offsets(Numel(out->sizes));
+    std::vector<int64_t> index(rank, 0);
+    for (auto& offset : offsets) {
+      offset = 0;
+      for (int64_t i = 0; i < rank; ++i) {
+        offset += (begin[i] + index[i] * step[i]) * strides[i];
+      }
+      NextIndex(out->sizes, &index);
+    }
+    Select(x, offsets, out);
+    return true;
+  }
+
+  bool FoldRange(const std::vector<Data>& inputs, Data* out) {
+    for (auto& input : inputs) {
+      if (input.elem_type != inputs[0].elem_type ||
+          Numel(input.sizes) != 1) {
+        return false;
+      }
+    }
+    out->elem_type = inputs[0].elem_type;
+    if (out->IsFloat()) {
+      double start = inputs[0].floats[0];
+      double delta = inputs[2].floats[0];
+      double count = std::ceil((inputs[1].floats[0] - start) / delta);
+      if (delta == 0 || std::isnan(count) || count > kMaxElements) {
+        return false;
+      }
+      for (int64_t i = 0; i < count; ++i) {
+        out->floats.push_back(start + i * delta);
+      }
+      if (out->elem_type == TensorProto_DataType_FLOAT) {
+        for (auto& value : out->floats) {
+          value = static_cast<float>(value);
+        }
+      }
+    } else {
+      int64_t start = inputs[0].ints[0];
+      int64_t delta = inputs[2].ints[0];
+      if (delta == 0) {
+        return false;
+      }
+      int64_t range = inputs[1].ints[0] - start;
+      int64_t count = range / delta + (range % delta != 0 ? 1 : 0);
+      if (count > kMaxElements) {
+        return false;
+      }
+      for (int64_t i = 0; i < count; ++i) {
+        out->ints.push_back(start + i * delta);
+      }
+    }
+    out->sizes = {static_cast<int64_t>(out->IsFloat() ? out->floats.size()
+                                                      : out->ints.size())};
+    return true;
+  }
+
+  bool FoldTile(const Data& x, const Data& repeats, Data* out) {
+    if (repeats.IsFloat() || repeats.ints.size() != x.sizes.size()) {
+      return false;
+    }
+    out->sizes = x.sizes;
+    for (size_t i = 0; i < x.sizes.size(); ++i) {
+      if (repeats.ints[i] < 0) {
+        return false;
+      }
+      out->sizes[i] *= repeats.ints[i];
+    }
+    if (Numel(out->sizes) < 0) {
+      return false;
+    }
+    std::vector<int64_t> strides = Strides(x.sizes);
+    std::vector<int64_t> offsets(Numel(out->sizes));
+    std::vector<int64_t> index(x.sizes.size(), 0);
+    for (auto& offset : offsets) {
+      offset = 0;
+      for (size_t i = 0; i < x.sizes.size(); ++i) {
+        offset += (index[i] % x.sizes[i]) * strides[i];
+      }
+      NextIndex(out->sizes, &index);
+    }
+    Select(x, offsets, out);
+    return true;
+  }
+
+  bool FoldExpand(const Data& x, const Data& shape, Data* out) {
+    if (shape.IsFloat() ||
+        !BroadcastSizes(x.sizes, shape.ints, &out->sizes)) {
+      return false;
+    }
+    Select(x, BroadcastOffsets(x.sizes, out->sizes), out);
+    return true;
+  }
+
+  bool FoldConstantOfShape(Node* n, const Data& shape, Data* out) {
+    out->elem_type = TensorProto_DataType_FLOAT;
+    out->sizes = shape.ints;
+    int64_t numel = Numel(out->sizes);
+    if (shape.IsFloat() || numel < 0) {
+      return false;
+    }
+    Data value;
+    value.elem_type = TensorProto_DataType_FLOAT;
+    value.floats = {0.0};
+    if (n->hasAttribute(kvalue) &&
+        (!Load(n->t(kvalue), &value) || Numel(value.sizes) != 1)) {
+      return false;
+    }
+    out->elem_type = value.elem_type;
+    if (value.IsFloat()) {
+      out->floats.assign(numel, value.floats[0]);
+    } else {
+      out->ints.assign(numel, value.ints[0]);
+    }
+    return true;
+  }
+
+  bool FoldTranspose(Node* n, const Data& x, Data* out) {
+    int64_t rank = x.sizes.size();
+    std::vector<int64_t> perm;
+    if (n->hasAttribute(kperm)) {
+      perm = n->is(kperm);
+    } else {
+      for (int64_t i = rank - 1; i >= 0; --i) {
+        perm.push_back(i);
+      }
+    }
+    if (static_cast<int64_t>(perm.size()) != rank) {
+      return false;
+    }
+    out->sizes.clear();
+    for (auto& axis : perm) {
+      if (axis < 0 || axis >= rank) {
+        return false;
+      }
+      out->sizes.push_back(x.sizes[axis]);
+    }
+    std::vector<int64_t> strides = Strides(x.sizes);
+    std::vector<int64_t> offsets(Numel(out->sizes));
+    std::vector<int64_t> index(rank, 0);
+    for (auto& offset : offsets) {
+      offset = 0;
+      for (int64_t i = 0; i < rank; ++i) {
+        offset += index[i] * strides[perm[i]];
+      }
+      NextIndex(out->sizes, &index);
+    }
+    Select(x, offsets, out);
+    return true;
+  }
+
+  bool FoldBinary(Node* n, const Data& x, const Data& y, Data* out) {
+    std::vector<int64_t> sizes;
+    if (x.elem_type != y.elem_type ||
+        !BroadcastSizes(x.sizes, y.sizes, &sizes)) {
+      return false;
+    }
+    std::string kind = n->kind().toString();
+    bool compare = kind == "Equal" || kind == "Less" || kind == "Greater";
+    out->elem_type = compare ? TensorProto_DataType_BOOL : x.elem_type;
+    out->sizes = sizes;
+    std::vector<int64_t> x_offsets = BroadcastOffsets(x.sizes, sizes);
+    std::vector<int64_t> y_offsets = BroadcastOffsets(y.sizes, sizes);
+    for (size_t i = 0; i < x_offsets.size(); ++i) {
+      double a = x.IsFloat() ? x.floats[x_offsets[i]] : 0;
+      double b = y.IsFloat() ? y.floats[y_offsets[i]] : 0;
+      int64_t p = x.IsFloat() ? 0 : x.ints[x_offsets[i]];
+      int64_t q = y.IsFloat() ? 0 : y.ints[y_offsets[i]];
+      if (compare) {
+        bool result = kind == "Equal" ? (x.IsFloat() ? a == b : p == q)
+                      : kind == "Less" ? (x.IsFloat() ? a < b : p < q)
+                                       : (x.IsFloat() ? a > b : p > q);
+        out->ints.push_back(result);
+      } else if (x.IsFloat()) {
+        double result = kind == "Add"   ? a + b
+                        : kind == "Sub" ? a - b
+                        : kind == "Mul" ? a * b
+                                        : a / b;
+        out->floats.push_back(x.elem_type == TensorProto_DataType_FLOAT
+                                  ? static_cast<float>(result)
+                                  : result);
+      } else {
+        if (x.elem_type == TensorProto_DataType_BOOL ||
+            (kind == "Div" && q == 0)) {
+          return false;
+        }
+        int64_t result = kind == "Add"   ? p + q
+                         : kind == "Sub" ? p - q
+                         : kind == "Mul" ? p * q
+                                         : p / q;
+        out->ints.push_back(x.elem_type == TensorProto_DataType_INT32
+                                ? static_cast<int32_t>(result)
+                                : result);
+      }
+    }
+    return true;
+  }
+
+  bool patternMatchPredicate(Node* node) override {
+    static const std::set<std::string> supported_ops = {
+        "Add",       "Cast",      "Concat",  "ConstantOfShape",
+        "Div",       "Equal",     "Expand",  "Gather",
+        "Greater",   "Less",      "Mul",     "Range",
+        "Reshape",   "Shape",     "Slice",   "Squeeze",
+        "Sub",       "Tile",      "Transpose", "Unsqueeze"};
+    if (node->outputs().size() != 1 || node->inputs().empty() ||
+        supported_ops.find(node->kind().toString()) == supported_ops.end()) {
+      return false;
+    }
+    if (node->kind() == Symbol("Shape")) {
+      return true;
+    }
+    for (auto& input : node->inputs()) {
+      if (input->node()->kind() != kUndefined && !IsConstant(input)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool runTransform(Node* n, Graph& graph,
+                    NodeDestroyType& destroy_current) override {
+    destroy_current = NodeDestroyType::DestroyZero;
+    std::string kind = n->kind().toString();
+    Data out;
+    if (n->kind() == Symbol("Shape")) {
+      if (!FoldShape(n, &out)) {
+        return false;
+      }
+    } else {
+      std::vector<Data> inputs(n->inputs().size());
+      for (size_t i = 0; i < inputs.size(); ++i) {
+        Value* input = n->inputs()[i];
+        if (input->node()->kind() != kUndefined &&
+            !Load(input->node()->t(kvalue), &inputs[i])) {
+          return false;
+        }
+      }
+      if (!inputs[0].Defined()) {
+        return false;
+      }
+      bool folded = false;
+      if (kind == "Cast") {
+        folded = FoldCast(n, inputs[0], &out);
+      } else if (kind == "Reshape") {
+        folded = FoldReshape(n, inputs[0], inputs[1], &out);
+      } else if (kind == "Unsqueeze") {
+        folded = FoldUnsqueeze(n, inputs, &out);
+      } else if (kind == "Squeeze") {
+        folded = FoldSqueeze(n, inputs, &out);
+      } else if (kind == "Concat") {
+        folded = FoldConcat(n, inputs, &out);
+      } else if (kind == "Gather") {
+        folded = FoldGather(n, inputs[0], inputs[1], &out);
+      } else if (kind == "Slice") {
+        folded = FoldSlice(n, inputs, &out);
+      } else if (kind == "Range") {
+        folded = inputs.size() == 3 && FoldRange(inputs, &out);
+      } else if (kind == "Tile") {
+        folded = FoldTile(inputs[0], inputs[1], &out);
+      } else if (kind == "Expand") {
+        folded = FoldExpand(inputs[0], inputs[1], &out);
+      } else if (kind == "ConstantOfShape") {
+        folded = FoldConstantOfShape(n, inputs[0], &out);
+      } else if (kind == "Transpose") {
+        folded = FoldTranspose(n, inputs[0], &out);
+      } else if (inputs.size() == 2) {
+        folded = FoldBinary(n, inputs[0], inputs[1], &out);
+      }
+      if (!folded) {
+        return false;
+      }
+    }
+    if (Numel(out.sizes) < 0) {
+      return false;
+    }
+
+    Node* constant = graph.create(kConstant, 1);
+    constant->insertBefore(n);
+    std::vector<Dimension> dims(out.sizes.begin(), out.sizes.end());
+    constant->output()->setSizes(dims);
+    constant->output()->setElemType(out.elem_type);
+    constant->t_(kvalue, Store(out));
+    if (!tryReplacingAllUsesWith(n->output(), constant->output())) {
+      return false;
+    }
+    destroy_current = NodeDestroyType::DestroyOne;
+    return true;
+  }
+};
+
+}  // namespace optimization
+}  // namespace ONNX_NAMESPACE
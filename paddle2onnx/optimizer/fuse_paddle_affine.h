@@ -0,0 +1,363 @@
+//   Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+// Fold the affine operators with constant operand, which come from
+// scale/dropout(downgrade_in_infer)/elementwise_mul/elementwise_add
+// 1. Merge runs of Mul/Add into one Mul and one Add
+//   Before:
+//     Y = Add(Mul(Add(Mul(X, S1), B1), S2), B2)
+//   After:
+//     Y = Add(Mul(X, S1 * S2), B1 * S2 + B2)
+// 2. Fold the per-tensor or per-channel Mul/Add into the constant weight and
+//    bias of Conv/Gemm, or Mul into the constant weight of MatMul
+//   Before:
+//     Y = Add(Mul(Conv(X, W, B), S1), B1)
+//   After:
+//     Y = Conv(X, W * S1, B * S1 + B1)
+
+#include <functional>
+#include <numeric>
+
+#include "onnx/defs/tensor_util.h"
+#include "onnxoptimizer/pass.h"
+
+namespace ONNX_NAMESPACE {
+namespace optimization {
+
+struct FusePaddleAffine final : public PredicateBasedPass {
+  explicit FusePaddleAffine()
+      : PredicateBasedPass(PassType::Fuse, PassEfficiency::Complete,
+                           PassOptimizationType::Compute) {}
+  std::string getPassName() const override { return "fuse_paddle_affine"; }
+
+  bool patternMatchPredicate(Node* node) override {
+    return (node->kind() == kMul || node->kind() == kAdd) &&
+           ConstantIndex(node) >= 0;
+  }
+
+  // Return the index of the FP32 constant input of Mul/Add, -1 if not exist
+  static int ConstantIndex(Node* node) {
+    if (node->inputs().size() != 2) {
+      return -1;
+    }
+    for (int i = 1; i >= 0; --i) {
+      Node* input = node->inputs()[i]->node();
+      if (input->kind() == kConstant && input->hasAttribute(kvalue) &&
+          input->t(kvalue).elem_type() == TensorProto_DataType_FLOAT) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  static std::vector<float> GetData(Value* value) {
+    Tensor t = value->node()->t(kvalue);
+    return ParseData<float>(&t);
+  }
+
+  // Compute `func(a, b)` with numpy-style broadcasting
+  static bool Broadcast(const std::vector<float>& a,
+                        const std::vector<int64_t>& a_shape,
+                        const std::vector<float>& b,
+                        const std::vector<int64_t>& b_shape,
+                        const std::function<float(float, float)>& func,
+                        std::vector<float>* out,
+                        std::vector<int64_t>* out_shape) {
+    size_t rank = std::max(a_shape.size(), b_shape.size());
+    std::vector<int64_t> a_dims(rank - a_shape.size(), 1);
+    std::vector<int64_t> b_dims(rank - b_shape.size(), 1);
+    a_dims.insert(a_dims.end(), a_shape.begin(), a_shape.end());
+    b_dims.insert(b_dims.end(), b_shape.begin(), b_shape.end());
+    out_shape->resize(rank);
+    for (size_t i = 0; i < rank; ++i) {
+      if (a_dims[i] != b_dims[i] && a_dims[i] != 1 && b_dims[i] != 1) {
+        return false;
+      }
+      (*out_shape)[i] = std::max(a_dims[i], b_dims[i]);
+    }
+    int64_t numel = std::accumulate(out_shape->begin(), out_shape->end(),
+                                    int64_t(1), std::multiplies<int64_t>());
+    out->resize(numel);
+    std::vector<int64_t> index(rank, 0);
+    for (int64_t i = 0; i < numel; ++i) {
+      int64_t a_offset = 0;
+      int64_t b_offset = 0;
+      for (size_t j = 0; j < rank; ++j) {
+        a_offset = a_offset * a_dims[j] + (a_dims[j] == 1 ? 0 : index[j]);
+        b_offset = b_offset * b_dims[j] + (b_dims[j] == 1 ? 0 : index[j]);
+      }
+      (*out)[i] = func(a[a_offset], b[b_offset]);
+      for (int64_t j = rank - 1; j >= 0; --j) {
+        if (++index[j] < (*out_shape)[j]) {
+          break;
+        }
+        index[j] = 0;
+      }
+    }
+    return true;
+  }
+
+  // Get the per-channel values of constant for output with rank `rank`, the
+  // constant should be a scalar or only has `channels` elements in `axis`
+  static bool GetChannelValues(Value* constant, int64_t rank, int64_t axis,
+                               int64_t channels, std::vector<float>* values) {
+    const auto& sizes = constant->node()->t(kvalue).sizes();
+    std::vector<float> data = GetData(constant);
+    if (data.size() == 1) {
+      values->assign(channels, data[0]);
+      return true;
+    }
+    if (sizes.size() > rank) {
+      return false;
+    }
+    int64_t offset = rank - sizes.size();
+    for (int64_t i = 0; i < sizes.size(); ++i) {
+      int64_t expected = (i + offset == axis) ? channels : 1;
+      if (sizes[i] != expected) {
+        return false;
+      }
+    }
+    *values = std::move(data);
+    return true;
+  }
+
+  // data[..., i, ...] = func(data[..., i, ...], values[i]) for i in `axis`
+  static void ApplyOnAxis(std::vector<float>* data,
+                          const std::vector<int64_t>& shape, int64_t axis,
+                          const std::vector<float>& values,
+                          const std::function<float(float, float)>& func) {
+    int64_t inner = std::accumulate(shape.begin() + axis + 1, shape.end(),
+                                    int64_t(1), std::multiplies<int64_t>());
+    for (size_t i = 0; i < data->size(); ++i) {
+      float& item = (*data)[i];
+      item = func(item, values[(i / inner) % shape[axis]]);
+    }
+  }
+
+  static void SetData(Node* constant, const std::vector<int64_t>& shape,
+                      std::vector<float>&& data) {
+    Tensor t;
+    t.elem_type() = TensorProto_DataType_FLOAT;
+    t.sizes() = shape;
+    t.floats() = std::move(data);
+    constant->t_(kvalue, std::move(t));
+    std::vector<Dimension> dims(shape.begin(), shape.end());
+    constant->output()->setSizes(dims);
+    constant->output()->setElemType(TensorProto_DataType_FLOAT);
+  }
+
+  static Value* MakeConstant(Graph& graph, Node* before,
+                             const std::vector<int64_t>& shape,
+                             std::vector<float>&& data) {
+    Node* constant = graph.create(kConstant, 1);
+    constant->insertBefore(before);
+    SetData(constant, shape, std::move(data));
+    return constant->output();
+  }
+
+  // Return true if `value` is a FP32 constant only used by one node
+  static bool IsFoldableWeight(Value* value) {
+    return value->node()->kind() == kConstant &&
+           value->node()->hasAttribute(kvalue) &&
+           value->node()->t(kvalue).elem_type() ==
+               TensorProto_DataType_FLOAT &&
+           value->uses().size() == 1;
+  }
+
+  // Fold Mul/Add into Conv/Gemm/MatMul, `node` is the Mul/Add and `layer` is
+  // the producer of its non-constant input
+  bool FoldIntoLayer(Node* node, Node* layer, Value* constant) {
+    const bool is_mul = node->kind() == kMul;
+    auto mul = [](float a, float b) { return a * b; };
+    auto add = [](float a, float b) { return a + b; };
+    if (layer->inputs().size() < 2 || !IsFoldableWeight(layer->inputs()[1])) {
+      return false;
+    }
+    Node* weight = layer->inputs()[1]->node();
+    std::vector<int64_t> weight_shape = weight->t(kvalue).sizes();
+    int64_t out_rank = 0;
+    int64_t out_axis = 0;
+    int64_t weight_axis = 0;
+    if (layer->kind() == kConv) {
+      out_rank = weight_shape.size();
+      out_axis = 1;
+      weight_axis = 0;
+    } else if (layer->kind() == kGemm) {
+      out_rank = 2;
+      out_axis = 1;
+      bool trans_b = layer->hasAttribute(ktransB) && layer->i(ktransB) != 0;
+      weight_axis = trans_b ? 0 : 1;
+    } else if (layer->kind() == kMatMul && is_mul) {
+      if (weight_shape.size() != 2 || !layer->inputs()[0]->has_sizes()) {
+        return false;
+      }
+      out_rank = layer->inputs()[0]->sizes().size();
+      out_axis = out_rank - 1;
+      weight_axis = 1;
+    } else {
+      return false;
+    }
+    if (weight_shape.size() < 2 || out_rank < 2) {
+      return false;
+    }
+    int64_t channels = weight_shape[weight_axis];
+    std::vector<float> values;
+    if (!GetChannelValues(constant, out_rank, out_axis, channels, &values)) {
+      return false;
+    }
+
+    // bias of Conv is [channels], and input C of Gemm supports broadcasting
+    Node* bias = nullptr;
+    std::vector<float> bias_data;
+    if (layer->kind() != kMatMul && layer->inputs().size() > 2) {
+      if (!IsFoldableWeight(layer->inputs()[2])) {
+        return false;
+      }
+      bias = layer->inputs()[2]->node();
+      bias_data = GetData(layer->inputs()[2]);
+      if (bias_data.size() == 1) {
+        bias_data.assign(channels, bias_data[0]);
+      } else if (bias_data.size() != channels) {
+        return false;
+      }
+    }
+    float beta = 1.0;
+    if (layer->kind() == kGemm && layer->hasAttribute(kbeta)) {
+      beta = layer->f(kbeta);
+    }
+    if (!is_mul && beta == 0.0) {
+      return false;
+    }
+
+    // Compute the folded weights first, the weights are changed only after
+    // the affine operator is removed
+    std::vector<float> weight_data;
+    if (is_mul) {
+      weight_data = GetData(layer->inputs()[1]);
+      ApplyOnAxis(&weight_data, weight_shape, weight_axis, values, mul);
+      if (bias != nullptr) {
+        ApplyOnAxis(&bias_data, {channels}, 0, values, mul);
+      }
+    } else {
+      for (auto& item : values) {
+        item /= beta;
+      }
+      if (bias != nullptr) {
+        ApplyOnAxis(&bias_data, {channels}, 0, values, add);
+      }
+    }
+    if (!tryReplacingAllUsesWith(node->output(), layer->output())) {
+      return false;
+    }
+    layer->output()->setSizes(node->output()->sizes());
+    layer->output()->setElemType(node->output()->elemType());
+
+    if (is_mul) {
+      SetData(weight, weight_shape, std::move(weight_data));
+    }
+    if (bias != nullptr) {
+      SetData(bias, {channels}, std::move(bias_data));
+    } else if (!is_mul) {
+      // Gemm without input C only exists while opset >= 11, so it's safe
+      // to add C here
+      layer->addInput(MakeConstant(*layer->owningGraph(), layer, {channels},
+                                   std::move(values)));
+    }
+    return true;
+  }
+
+  bool runTransform(Node* n, Graph& graph,
+                    NodeDestroyType& destroy_current) override {
+    destroy_current = NodeDestroyType::DestroyZero;
+    bool changed = false;
+    auto mul = [](float a, float b) { return a * b; };
+    auto add = [](float a, float b) { return a + b; };
+
+    while (true) {
+      int index = ConstantIndex(n);
+      Value* constant = n->inputs()[index];
+      Value* input = n->inputs()[1 - index];
+      if (input->uses().size() > 1) {
+        break;
+      }
+      Node* producer = input->node();
+      if (producer->kind() == kConv || producer->kind() == kGemm ||
+          producer->kind() == kMatMul) {
+        if (FoldIntoLayer(n, producer, constant)) {
+          destroy_current = NodeDestroyType::DestroyOne;
+          return true;
+        }
+        break;
+      }
+      if ((producer->kind() != kMul && producer->kind() != kAdd) ||
+          ConstantIndex(producer) < 0) {
+        break;
+      }
+      int producer_index = ConstantIndex(producer);
+      Value* producer_constant = producer->inputs()[producer_index];
+      Value* x = producer->inputs()[1 - producer_index];
+
+      const auto& shape = constant->node()->t(kvalue).sizes();
+      const auto& producer_shape = producer_constant->node()->t(kvalue).sizes();
+      std::vector<float> merged;
+      std::vector<int64_t> merged_shape;
+      if (producer->kind() == n->kind()) {
+        // Mul(Mul(X, S1), S2) = Mul(X, S1 * S2)
+        // Add(Add(X, B1), B2) = Add(X, B1 + B2)
+        if (!Broadcast(GetData(producer_constant), producer_shape,
+                       GetData(constant), shape,
+                       n->kind() == kMul ? mul : add, &merged,
+                       &merged_shape)) {
+          break;
+        }
+        n->replaceInput(index, MakeConstant(graph, n, merged_shape,
+                                            std::move(merged)));
+        n->replaceInput(1 - index, x);
+      } else if (n->kind() == kMul) {
+        // Mul(Add(X, B1), S2) = Add(Mul(X, S2), B1 * S2)
+        if (!Broadcast(GetData(producer_constant), producer_shape,
+                       GetData(constant), shape, mul, &merged,
+                       &merged_shape)) {
+          break;
+        }
+        Value* output = n->output();
+        if (!tryReplacingAllUsesWith(output, input)) {
+          break;
+        }
+        input->setSizes(output->sizes());
+        input->setElemType(output->elemType());
+        n->replaceInput(1 - index, x);
+        producer->replaceInput(producer_index,
+                               MakeConstant(graph, n, merged_shape,
+                                            std::move(merged)));
+        producer->replaceInput(1 - producer_index, output);
+        producer->moveAfter(n);
+      } else {
+        // Add(Mul(X, S1), B2) is the expected order
+        break;
+      }
+      changed = true;
+    }
+    return changed;
+  }
+};
+
+}  // namespace optimization
+}  // namespace ONNX_NAMESPACE
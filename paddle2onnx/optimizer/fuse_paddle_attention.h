@@ -0,0 +1,264 @@
+//   Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+// Fuse the attention block of transformer models into the MultiHeadAttention
+// operator of onnxruntime(domain com.microsoft)
+// Before:
+//   Q = Transpose(Reshape(X_q, [0, 0, H, D]), perm=[0, 2, 1, 3])
+//   K = Transpose(Reshape(X_k, [0, 0, H, D]), perm=[0, 2, 1, 3])
+//   V = Transpose(Reshape(X_v, [0, 0, H, D]), perm=[0, 2, 1, 3])
+//   P = Softmax(Add(Mul(MatMul(Q, Transpose(K, perm=[0, 1, 3, 2])), S), M))
+//   Y = Reshape(Transpose(MatMul(P, V), perm=[0, 2, 1, 3]), [0, 0, H * D])
+// After:
+//   Y = MultiHeadAttention(X_q, X_k, X_v, "", "", Expand(M, [1, H, S, L]))
+// The scale S may also be applied on Q, and the mask M is optional
+
+#include <vector>
+
+#include "onnx/defs/tensor_util.h"
+#include "onnxoptimizer/pass.h"
+
+namespace ONNX_NAMESPACE {
+namespace optimization {
+
+struct FusePaddleAttention final : public PredicateBasedPass {
+  explicit FusePaddleAttention()
+      : PredicateBasedPass(PassType::Fuse, PassEfficiency::Complete,
+                           PassOptimizationType::Compute) {}
+  std::string getPassName() const override { return "fuse_paddle_attention"; }
+
+  bool patternMatchPredicate(Node* node) override {
+    return node->kind() == kReshape;
+  }
+
+  static bool GetScalar(Value* value, float* scalar) {
+    Node* node = value->node();
+    if (node->kind() != kConstant || !node->hasAttribute(kvalue) ||
+        node->t(kvalue).elem_type() != TensorProto_DataType_FLOAT) {
+      return false;
+    }
+    Tensor t = node->t(kvalue);
+    std::vector<float> data = ParseData<float>(&t);
+    if (data.size() != 1) {
+      return false;
+    }
+    *scalar = data[0];
+    return true;
+  }
+
+  static bool GetShape(Node* reshape, std::vector<int64_t>* shape) {
+    if (reshape->hasAttribute(Symbol("allowzero")) &&
+        reshape->i(Symbol("allowzero")) != 0) {
+      return false;
+    }
+    Node* node = reshape->inputs()[1]->node();
+    if (node->kind() != kConstant || !node->hasAttribute(kvalue) ||
+        node->t(kvalue).elem_type() != TensorProto_DataType_INT64) {
+      return false;
+    }
+    Tensor t = node->t(kvalue);
+    *shape = ParseData<int64_t>(&t);
+    return true;
+  }
+
+  // Skip the single-used Transposes from `value`, `perm` is the merged
+  // permutation from the returned value to `value`
+  static Value* SkipTransposes(Value* value, std::vector<int64_t>* perm) {
+    perm->clear();
+    while (value->node()->kind() == kTranspose &&
+           value->node()->hasAttribute(kperm) && value->uses().size() == 1) {
+      std::vector<int64_t> inner = value->node()->is(kperm);
+      if (perm->empty()) {
+        *perm = inner;
+      } else {
+        if (inner.size() != perm->size()) {
+          return value;
+        }
+        std::vector<int64_t> merged(perm->size());
+        for (size_t i = 0; i < perm->size(); ++i) {
+          merged[i] = inner[(*perm)[i]];
+        }
+        *perm = merged;
+      }
+      value = value->node()->inputs()[0];
+    }
+    return value;
+  }
+
+  // Match the heads splitting Transpose(Reshape(X, [0, 0, H, D]), perm),
+  // return X or nullptr if not matched
+  static Value* SplitHeads(Value* value, const std::vector<int64_t>& perm,
+                           int64_t* heads) {
+    std::vector<int64_t> merged;
+    Value* reshaped = SkipTransposes(value, &merged);
+    std::vector<int64_t> shape;
+    if (merged != perm || reshaped->node()->kind() != kReshape ||
+        reshaped->uses().size() != 1 ||
+        !GetShape(reshaped->node(), &shape)) {
+      return nullptr;
+    }
+    if (shape.size() != 4 || shape[0] != 0 || shape[1] != 0 || shape[2] <= 0 ||
+        shape[3] <= 0) {
+      return nullptr;
+    }
+    // The inputs of MultiHeadAttention should be in shape of [B, S, H * D]
+    Value* input = reshaped->node()->inputs()[0];
+    if (input->has_sizes() && input->sizes().size() != 3) {
+      return nullptr;
+    }
+    *heads = shape[2];
+    return input;
+  }
+
+  static Value* MakeConstant(Graph& graph, Node* before,
+                             const std::vector<int64_t>& data) {
+    Tensor t;
+    t.elem_type() = TensorProto_DataType_INT64;
+    t.sizes() = {static_cast<int64_t>(data.size())};
+    t.int64s() = data;
+    Node* constant = graph.create(kConstant, 1);
+    constant->insertBefore(before);
+    constant->t_(kvalue, std::move(t));
+    constant->output()->setSizes(
+        {Dimension(static_cast<int64_t>(data.size()))});
+    constant->output()->setElemType(TensorProto_DataType_INT64);
+    return constant->output();
+  }
+
+  // Get dimension 1 of `value` as a 1-D tensor
+  static Value* SequenceLength(Graph& graph, Node* before, Value* value) {
+    Node* shape = graph.create(Symbol("Shape"), 1);
+    shape->addInput(value);
+    shape->insertBefore(before);
+    Node* gather = graph.create(Symbol("Gather"), 1);
+    gather->addInput(shape->output());
+    gather->addInput(MakeConstant(graph, before, {1}));
+    gather->i_(kaxis, 0);
+    gather->insertBefore(before);
+    return gather->output();
+  }
+
+  bool runTransform(Node* n, Graph& graph,
+                    NodeDestroyType& destroy_current) override {
+    destroy_current = NodeDestroyType::DestroyZero;
+    const std::vector<int64_t> heads_perm = {0, 2, 1, 3};
+    std::vector<int64_t> shape;
+    if (!GetShape(n, &shape) || shape.size() != 3 || shape[0] != 0 ||
+        shape[1] != 0) {
+      return false;
+    }
+    std::vector<int64_t> perm;
+    Value* context = SkipTransposes(n->inputs()[0], &perm);
+    if (perm != heads_perm || context->node()->kind() != kMatMul ||
+        context->uses().size() != 1) {
+      return false;
+    }
+    Node* matmul_v = context->node();
+    Value* probs = matmul_v->inputs()[0];
+    if (probs->node()->kind() != kSoftmax || probs->uses().size() != 1 ||
+        !probs->node()->hasAttribute(kaxis)) {
+      return false;
+    }
+    int64_t axis = probs->node()->i(kaxis);
+    if (axis != -1 && axis != 3) {
+      return false;
+    }
+
+    Value* scores = probs->node()->inputs()[0];
+    Value* mask = nullptr;
+    if (scores->node()->kind() == kAdd && scores->uses().size() == 1) {
+      Node* add = scores->node();
+      int data_index = (add->inputs()[0]->node()->kind() == kMul ||
+                        add->inputs()[0]->node()->kind() == kMatMul)
+                           ? 0
+                           : 1;
+      mask = add->inputs()[1 - data_index];
+      scores = add->inputs()[data_index];
+    }
+    float scale = 1.0;
+    float value = 1.0;
+    if ((scores->node()->kind() == kMul || scores->node()->kind() == kDiv) &&
+        scores->uses().size() == 1 &&
+        GetScalar(scores->node()->inputs()[1], &value)) {
+      scale = scores->node()->kind() == kMul ? value : 1.0 / value;
+      scores = scores->node()->inputs()[0];
+    }
+    if (scores->node()->kind() != kMatMul || scores->uses().size() != 1) {
+      return false;
+    }
+    Node* matmul_qk = scores->node();
+    Value* query = matmul_qk->inputs()[0];
+    if (query->node()->kind() == kMul && query->uses().size() == 1 &&
+        GetScalar(query->node()->inputs()[1], &value)) {
+      scale *= value;
+      query = query->node()->inputs()[0];
+    }
+
+    int64_t q_heads = 0;
+    int64_t k_heads = 0;
+    int64_t v_heads = 0;
+    Value* q = SplitHeads(query, heads_perm, &q_heads);
+    Value* k = SplitHeads(matmul_qk->inputs()[1], {0, 2, 3, 1}, &k_heads);
+    Value* v = SplitHeads(matmul_v->inputs()[1], heads_perm, &v_heads);
+    if (q == nullptr || k == nullptr || v == nullptr || q_heads != k_heads ||
+        q_heads != v_heads) {
+      return false;
+    }
+
+    Node* attention = graph.create(Symbol("MultiHeadAttention"), 1);
+    attention->setDomain("com.microsoft");
+    attention->addInput(q);
+    attention->addInput(k);
+    attention->addInput(v);
+    attention->i_(Symbol("num_heads"), q_heads);
+    attention->f_(Symbol("scale"), scale);
+    if (mask != nullptr) {
+      // The attention bias should be in shape of [B or 1, H, S, L]
+      Node* undefined = graph.create(kUndefined, 1);
+      undefined->insertBefore(n);
+      Node* concat = graph.create(kConcat, 1);
+      concat->addInput(MakeConstant(graph, n, {1, q_heads}));
+      concat->addInput(SequenceLength(graph, n, q));
+      concat->addInput(SequenceLength(graph, n, k));
+      concat->i_(kaxis, 0);
+      concat->insertBefore(n);
+      Node* expand = graph.create(kExpand, 1);
+      expand->addInput(mask);
+      expand->addInput(concat->output());
+      expand->insertBefore(n);
+      attention->addInput(undefined->output());
+      attention->addInput(undefined->output());
+      attention->addInput(expand->output());
+    }
+    attention->insertBefore(n);
+    if (n->output()->has_sizes()) {
+      attention->output()->setSizes(n->output()->sizes());
+    }
+    attention->output()->setElemType(n->output()->elemType());
+    if (!tryReplacingAllUsesWith(n->output(), attention->output())) {
+      return false;
+    }
+    destroy_current = NodeDestroyType::DestroyOne;
+    return true;
+  }
+};
+
+}  // namespace optimization
+}  // namespace ONNX_NAMESPACE
@@ -0,0 +1,206 @@
+//   Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+// Before:
+//   X = Conv/ConvTranspose(Input, Constant[, Constant])
+//   Y = BatchNormalization(X, Constant, Constant, Constant, Constant)
+// After:
+//   Y = Conv/ConvTranspose(Input, Constant, Constant)
+// The factor of BatchNormalization is folded into the weight and bias of
+// convolution, supports conv2d/depthwise_conv2d/conv2d_transpose
+
+#include <cmath>
+#include <numeric>
+
+#include "onnx/defs/tensor_util.h"
+#include "onnxoptimizer/pass.h"
+
+namespace ONNX_NAMESPACE {
+namespace optimization {
+
+struct FusePaddleConvBN final : public PredicateBasedPass {
+  explicit FusePaddleConvBN()
+      : PredicateBasedPass(PassType::Fuse, PassEfficiency::Complete,
+                           PassOptimizationType::Compute) {}
+  std::string getPassName() const override { return "fuse_paddle_conv_bn"; }
+
+  bool patternMatchPredicate(Node* node) override {
+    if (node->kind() != kBatchNormalization || node->inputs().size() != 5) {
+      return false;
+    }
+    Node* conv = node->inputs()[0]->node();
+    if (conv->kind() != kConv && conv->kind() != kConvTranspose) {
+      return false;
+    }
+    for (size_t i = 1; i < node->inputs().size(); ++i) {
+      if (node->inputs()[i]->node()->kind() != kConstant) {
+        return false;
+      }
+    }
+    return conv->inputs()[1]->node()->kind() == kConstant;
+  }
+
+  bool GetFloatData(Node* constant, std::vector<float>* data) {
+    Tensor t = constant->t(kvalue);
+    if (t.elem_type() != TensorProto_DataType_FLOAT) {
+      return false;
+    }
+    *data = ParseData<float>(&t);
+    return true;
+  }
+
+  bool runTransform(Node* n, Graph& graph,
+                    NodeDestroyType& destroy_current) override {
+    destroy_current = NodeDestroyType::DestroyZero;
+
+    Node* bn = n;
+    Node* conv = n->inputs()[0]->node();
+    // BatchNormalization in training mode has more than 1 output
+    if (bn->outputs().size() > 1) {
+      return false;
+    }
+    // check if Conv is only used by BatchNormalization
+    if (bn->inputs()[0]->uses().size() > 1) {
+      return false;
+    }
+    // check if weight is only used by Conv
+    if (conv->inputs()[1]->uses().size() > 1) {
+      return false;
+    }
+    Node* weight = conv->inputs()[1]->node();
+    Node* bias = nullptr;
+    if (conv->inputs().size() > 2) {
+      bias = conv->inputs()[2]->node();
+      if (bias->kind() != kConstant || conv->inputs()[2]->uses().size() > 1) {
+        return false;
+      }
+    }
+
+    std::vector<float> weight_data;
+    std::vector<float> scale;
+    std::vector<float> shift;
+    std::vector<float> mean;
+    std::vector<float> variance;
+    if (!GetFloatData(weight, &weight_data) ||
+        !GetFloatData(bn->inputs()[1]->node(), &scale) ||
+        !GetFloatData(bn->inputs()[2]->node(), &shift) ||
+        !GetFloatData(bn->inputs()[3]->node(), &mean) ||
+        !GetFloatData(bn->inputs()[4]->node(), &variance)) {
+      return false;
+    }
+    Tensor weight_tensor = weight->t(kvalue);
+    const auto weight_shape = weight_tensor.sizes();
+    if (weight_shape.size() < 3) {
+      return false;
+    }
+    int64_t group = 1;
+    if (conv->hasAttribute(kgroup)) {
+      group = conv->i(kgroup);
+    }
+    // weight of Conv is [out, in / group, kernel...]
+    // weight of ConvTranspose is [in, out / group, kernel...]
+    int64_t out_channels = weight_shape[0];
+    if (conv->kind() == kConvTranspose) {
+      out_channels = weight_shape[1] * group;
+    }
+    if (scale.size() != out_channels || shift.size() != out_channels ||
+        mean.size() != out_channels || variance.size() != out_channels) {
+      return false;
+    }
+    std::vector<float> bias_data(out_channels, 0.0);
+    if (bias != nullptr) {
+      if (!GetFloatData(bias, &bias_data) ||
+          bias_data.size() != out_channels) {
+        return false;
+      }
+    }
+
+    float epsilon = 1e-05;
+    if (bn->hasAttribute(kepsilon)) {
+      epsilon = bn->f(kepsilon);
+    }
+    std::vector<float> factor(out_channels);
+    for (int64_t i = 0; i < out_channels; ++i) {
+      factor[i] = scale[i] / std::sqrt(variance[i] + epsilon);
+      bias_data[i] = (bias_data[i] - mean[i]) * factor[i] + shift[i];
+    }
+
+    int64_t kernel_size = std::accumulate(weight_shape.begin() + 2,
+                                          weight_shape.end(), int64_t(1),
+                                          std::multiplies<int64_t>());
+    if (conv->kind() == kConv) {
+      int64_t inner_size = weight_shape[1] * kernel_size;
+      for (int64_t i = 0; i < out_channels; ++i) {
+        for (int64_t j = 0; j < inner_size; ++j) {
+          weight_data[i * inner_size + j] *= factor[i];
+        }
+      }
+    } else {
+      int64_t in_per_group = weight_shape[0] / group;
+      for (int64_t i = 0; i < weight_shape[0]; ++i) {
+        int64_t out_offset = (i / in_per_group) * weight_shape[1];
+        for (int64_t j = 0; j < weight_shape[1]; ++j) {
+          float f = factor[out_offset + j];
+          float* data =
+              weight_data.data() + (i * weight_shape[1] + j) * kernel_size;
+          for (int64_t k = 0; k < kernel_size; ++k) {
+            data[k] *= f;
+          }
+        }
+      }
+    }
+
+    // The weights are changed only after BatchNormalization is removed
+    const bool replacing_success =
+        tryReplacingAllUsesWith(bn->output(), bn->inputs()[0]);
+    if (!replacing_success) {
+      return false;
+    }
+    conv->output()->setSizes(bn->output()->sizes());
+    conv->output()->setElemType(bn->output()->elemType());
+
+    Tensor new_weight;
+    new_weight.elem_type() = TensorProto_DataType_FLOAT;
+    new_weight.sizes() = weight_shape;
+    new_weight.floats() = std::move(weight_data);
+    weight->t_(kvalue, std::move(new_weight));
+
+    Tensor new_bias;
+    new_bias.elem_type() = TensorProto_DataType_FLOAT;
+    new_bias.sizes().push_back(out_channels);
+    new_bias.floats() = std::move(bias_data);
+    if (bias != nullptr) {
+      bias->t_(kvalue, std::move(new_bias));
+    } else {
+      bias = graph.create(kConstant, 1);
+      bias->insertBefore(conv);
+      bias->t_(kvalue, std::move(new_bias));
+      bias->output()->setSizes({Dimension(out_channels)});
+      bias->output()->setElemType(TensorProto_DataType_FLOAT);
+      conv->addInput(bias->output());
+    }
+
+    destroy_current = NodeDestroyType::DestroyOne;
+    return true;
+  }
+};
+
+}  // namespace optimization
+}  // namespace ONNX_NAMESPACE
@@ -14,7 +14,9 @@
 
 #include "paddle2onnx/parser/parser.h"
 
+#include <cstring>
 #include <fstream>
+#include <set>
 #include <sstream>
 #include <string>
 
@@ -106,8 +108,8 @@ bool PaddleParser::LoadParamsFromMemoryBuffer(
   GetParamNames(&var_names);
 
   int read_size = 0;
+  size_t index = 0;
   while (read_size < total_size) {
-    auto index = params.size();
     if (index >= var_names.size()) {
       P2OLogger() << "Unexcepted situation happend, while reading the "
                      "parameters of PaddlePaddle model."
@@ -167,11 +169,17 @@ bool PaddleParser::LoadParamsFromMemoryBuffer(
       }
 
       // read weight data
+      if (_unused_params.find(var_names[index]) != _unused_params.end()) {
+        read_size += numel * PaddleDataTypeSize(data_type);
+        index += 1;
+        continue;
+      }
       weight.buffer.resize(numel * PaddleDataTypeSize(data_type));
       params_buffer.copy(weight.buffer.data(),
                          numel * PaddleDataTypeSize(data_type), read_size);
       read_size += numel * PaddleDataTypeSize(data_type);
       params[var_names[index]] = weight;
+      index += 1;
     }
   }
   return true;
@@ -192,6 +200,7 @@ bool PaddleParser::LoadParams(const std::string& path) {
   GetParamNames(&var_names);
 
   int read_size = 0;
+  size_t index = 0;
   while (read_size < total_size) {
     {
       // read version, we don't need this
@@ -238,18 +247,23 @@ bool PaddleParser::LoadParams(const std::string& path) {
         weight.shape.push_back(tensor_desc->dims()[i]);
       }
 
-      // read weight data
-      weight.buffer.resize(numel * PaddleDataTypeSize(data_type));
-      read_size += numel * PaddleDataTypeSize(data_type);
-      is.read(weight.buffer.data(), numel * PaddleDataTypeSize(data_type));
-      auto index = params.size();
       if (index >= var_names.size()) {
         P2OLogger() << "Unexcepted situation happend while reading parameters "
                        "of PaddlePaddle model."
                     << std::endl;
         return false;
       }
+      // read weight data
+      read_size += numel * PaddleDataTypeSize(data_type);
+      if (_unused_params.find(var_names[index]) != _unused_params.end()) {
+        is.seekg(numel * PaddleDataTypeSize(data_type), std::ios::cur);
+        index += 1;
+        continue;
+      }
+      weight.buffer.resize(numel * PaddleDataTypeSize(data_type));
+      is.read(weight.buffer.data(), numel * PaddleDataTypeSize(data_type));
       params[var_names[index]] = weight;
+      index += 1;
     }
   }
   is.close();
@@ -286,6 +300,7 @@ bool PaddleParser::Init(const std::string& _model, const std::string& _params,
     P2OLogger() << "Failed to load program of PaddlePaddle model." << std::endl;
     return false;
   }
+  RemoveDeadOps();
   if (_params != "") {
     auto ret = true;
     if (from_memory_buffer) {
@@ -309,10 +324,105 @@ bool PaddleParser::Init(const std::string& _model, const std::string& _params,
   //  }
   GetBlocksVarName2Id();
   GetBlocksOps();
+  ZeroPaddingParams();
   GetGlobalBlockInputOutputInfo();
   return true;
 }
 
+// Collect the sub blocks referenced by the attributes of operator
+static void GetSubBlocks(const framework::proto::OpDesc& op,
+                         std::vector<int32_t>* blocks) {
+  for (auto& attr : op.attrs()) {
+    if (attr.has_block_idx()) {
+      blocks->push_back(attr.block_idx());
+    }
+    for (auto& idx : attr.blocks_idx()) {
+      blocks->push_back(idx);
+    }
+  }
+}
+
+void PaddleParser::RemoveDeadOps() {
+  _unused_params.clear();
+  _num_dead_ops = 0;
+  auto global_block = prog->mutable_blocks(0);
+  bool has_fetch = false;
+  for (auto& op : global_block->ops()) {
+    has_fetch = has_fetch || op.type() == "fetch";
+  }
+  if (!has_fetch) {
+    return;
+  }
+
+  // Traverse the global block reversely from the fetch targets, the variables
+  // may be written by several operators, so they are never removed from the
+  // live set
+  std::set<std::string> live_vars;
+  std::vector<bool> live_ops(global_block->ops_size(), false);
+  std::vector<bool> live_blocks(prog->blocks_size(), false);
+  live_blocks[0] = true;
+  std::vector<int32_t> sub_blocks;
+  for (auto i = global_block->ops_size() - 1; i >= 0; --i) {
+    auto& op = global_block->ops(i);
+    bool is_live = op.type() == "feed" || op.type() == "fetch";
+    for (auto& output : op.outputs()) {
+      for (auto& arg : output.arguments()) {
+        is_live = is_live || live_vars.find(arg) != live_vars.end();
+      }
+    }
+    if (!is_live) {
+      continue;
+    }
+    live_ops[i] = true;
+    for (auto& input : op.inputs()) {
+      live_vars.insert(input.arguments().begin(), input.arguments().end());
+    }
+    // The variables of global block read by the sub blocks are live too
+    GetSubBlocks(op, &sub_blocks);
+    while (!sub_blocks.empty()) {
+      auto block_idx = sub_blocks.back();
+      sub_blocks.pop_back();
+      if (block_idx <= 0 || block_idx >= prog->blocks_size() ||
+          live_blocks[block_idx]) {
+        continue;
+      }
+      live_blocks[block_idx] = true;
+      for (auto& sub_op : prog->blocks(block_idx).ops()) {
+        for (auto& input : sub_op.inputs()) {
+          live_vars.insert(input.arguments().begin(),
+                           input.arguments().end());
+        }
+        GetSubBlocks(sub_op, &sub_blocks);
+      }
+    }
+  }
+
+  int32_t num_kept = 0;
+  auto ops = global_block->mutable_ops();
+  for (auto i = 0; i < ops->size(); ++i) {
+    if (live_ops[i]) {
+      ops->SwapElements(num_kept, i);
+      num_kept += 1;
+    }
+  }
+  _num_dead_ops = ops->size() - num_kept;
+  ops->DeleteSubrange(num_kept, _num_dead_ops);
+  for (auto i = 1; i < prog->blocks_size(); ++i) {
+    if (!live_blocks[i]) {
+      _num_dead_ops += prog->blocks(i).ops_size();
+      prog->mutable_blocks(i)->clear_ops();
+    }
+  }
+
+  std::vector<std::string> param_names;
+  GetParamNames(&param_names);
+  for (auto& name : param_names) {
+    if (live_vars.find(name) == live_vars.end()) {
+      _unused_params.insert(name);
+    }
+  }
+}
+
 bool PaddleParser::IsConstantTensor(const int64_t& block_id,
                                     const std::string& tensor_name) const {
   Assert(block_id < _constant_ops.size(),
@@ -334,6 +444,7 @@ void PaddleParser::GetBlocksVarName2Id() {
 void PaddleParser::GetBlocksOps() {
   _blocks_ops.clear();
   _constant_ops.clear();
+  _param_consumers.clear();
   _blocks_ops.resize(prog->blocks_size());
   _constant_ops.resize(prog->blocks_size());
   for (auto i = 0; i < prog->blocks_size(); ++i) {
@@ -343,7 +454,62 @@ void PaddleParser::GetBlocksOps() {
       if (prog->blocks(i).ops(j).type() == "assign_value") {
         _constant_ops[i][prog->blocks(i).ops(j).outputs(0).arguments(0)] = j;
       }
+      for (auto& input : prog->blocks(i).ops(j).inputs()) {
+        for (auto& arg : input.arguments()) {
+          if (params.find(arg) != params.end()) {
+            _param_consumers[arg].push_back(std::make_pair(i, j));
+          }
+        }
+      }
+    }
+  }
+}
+
+std::vector<std::pair<int64_t, int64_t>> PaddleParser::GetParamConsumers(
+    const std::string& name) const {
+  auto iter = _param_consumers.find(name);
+  if (iter == _param_consumers.end()) {
+    return {};
+  }
+  return iter->second;
+}
+
+void PaddleParser::ZeroPaddingParams() {
+  _zero_padding_params.clear();
+  for (auto& item : _param_consumers) {
+    auto& weight = params[item.first];
+    if (weight.shape.size() == 0 || weight.shape[0] <= 0) {
+      continue;
+    }
+    int64_t padding_idx = -1;
+    for (size_t i = 0; i < item.second.size(); ++i) {
+      auto& op = GetOpDesc(item.second[i].first, item.second[i].second);
+      int64_t op_padding_idx = -1;
+      if ((op.type() != "lookup_table" && op.type() != "lookup_table_v2") ||
+          !OpHasAttr(op, "padding_idx")) {
+        padding_idx = -1;
+        break;
+      }
+      GetOpAttr(op, "padding_idx", &op_padding_idx);
+      bool is_weight = false;
+      for (auto& input : op.inputs()) {
+        is_weight = is_weight || (input.parameter() == "W" &&
+                                  input.arguments_size() == 1 &&
+                                  input.arguments(0) == item.first);
+      }
+      if (!is_weight || (i > 0 && op_padding_idx != padding_idx)) {
+        padding_idx = -1;
+        break;
+      }
+      padding_idx = op_padding_idx;
+    }
+    if (padding_idx < 0 || padding_idx >= weight.shape[0]) {
+      continue;
     }
+    // The padding row is all zero bytes for any data type
+    size_t row_bytes = weight.buffer.size() / weight.shape[0];
+    std::memset(weight.buffer.data() + padding_idx * row_bytes, 0, row_bytes);
+    _zero_padding_params.insert(item.first);
   }
 }
 
@@ -634,6 +800,368 @@ void PaddleParser::GetGlobalBlockInputOutputInfo() {
   }
 }
 
+// Return the arguments of parameter `name` in the inputs/outputs of operator
+static std::vector<std::string> GetArguments(
+    const google::protobuf::RepeatedPtrField<framework::proto::OpDesc::Var>&
+        vars,
+    const std::string& name) {
+  for (auto i = 0; i < vars.size(); ++i) {
+    if (vars.Get(i).parameter() == name) {
+      return std::vector<std::string>(vars.Get(i).arguments().begin(),
+                                      vars.Get(i).arguments().end());
+    }
+  }
+  return std::vector<std::string>();
+}
+
+// Numpy style broadcasting, -1 means the dimension is unknown
+static std::vector<int64_t> BroadcastShape(const std::vector<int64_t>& x,
+                                           const std::vector<int64_t>& y) {
+  std::vector<int64_t> out(std::max(x.size(), y.size()), -1);
+  for (size_t i = 0; i < out.size(); ++i) {
+    int64_t a = i < x.size() ? x[x.size() - 1 - i] : 1;
+    int64_t b = i < y.size() ? y[y.size() - 1 - i] : 1;
+    if (a == 1) {
+      out[out.size() - 1 - i] = b;
+    } else if (b == 1) {
+      out[out.size() - 1 - i] = a;
+    } else {
+      out[out.size() - 1 - i] = a > 0 ? a : b;
+    }
+  }
+  return out;
+}
+
+// Output size of the sliding window in convolution and pooling
+static int64_t WindowOutputSize(int64_t size, int64_t kernel, int64_t stride,
+                                int64_t dilation, int64_t pads,
+                                bool ceil_mode) {
+  int64_t range = size + pads - dilation * (kernel - 1) - 1;
+  if (size < 0 || stride <= 0 || range < 0) {
+    return -1;
+  }
+  return (ceil_mode ? (range + stride - 1) / stride : range / stride) + 1;
+}
+
+std::vector<int64_t> PaddleParser::GetVarShape(const std::string& name) const {
+  std::vector<int64_t> shape;
+  auto iter = _blocks_var_name2id[0].find(name);
+  if (iter == _blocks_var_name2id[0].end()) {
+    return shape;
+  }
+  auto& type = prog->blocks(0).vars(iter->second).type();
+  if (!type.has_lod_tensor()) {
+    return shape;
+  }
+  auto& tensor = type.lod_tensor().tensor();
+  for (auto i = 0; i < tensor.dims_size(); ++i) {
+    shape.push_back(tensor.dims(i));
+  }
+  return shape;
+}
+
+void PaddleParser::RefineVarShape(const std::string& name,
+                                  const std::vector<int64_t>& shape) {
+  auto iter = _blocks_var_name2id[0].find(name);
+  if (iter == _blocks_var_name2id[0].end()) {
+    return;
+  }
+  auto type =
+      prog->mutable_blocks(0)->mutable_vars(iter->second)->mutable_type();
+  if (!type->has_lod_tensor()) {
+    return;
+  }
+  auto tensor = type->mutable_lod_tensor()->mutable_tensor();
+  if (tensor->dims_size() != static_cast<int>(shape.size())) {
+    return;
+  }
+  // Only the unknown dimensions will be refined
+  for (size_t i = 0; i < shape.size(); ++i) {
+    if (tensor->dims(i) < 0 && shape[i] >= 0) {
+      tensor->set_dims(i, shape[i]);
+    }
+  }
+}
+
+bool PaddleParser::InferShape(const paddle2onnx::framework::proto::OpDesc& op,
+                              std::string* output,
+                              std::vector<int64_t>* shape) const {
+  static const std::set<std::string> unary_ops = {
+      "abs", "assign", "cast", "ceil", "clip", "cos", "dropout", "elu", "erf",
+      "exp", "floor", "gelu", "hard_shrink", "hard_sigmoid", "hard_swish",
+      "leaky_relu", "log", "log_softmax", "logical_not", "mish", "pow", "prelu",
+      "reciprocal", "relu", "relu6", "round", "rsqrt", "scale", "selu",
+      "sigmoid", "sign", "silu", "sin", "softmax", "softplus", "softshrink",
+      "softsign", "sqrt", "square", "swish", "tanh", "tanh_shrink",
+      "thresholded_relu"};
+  static const std::set<std::string> norm_ops = {
+      "batch_norm", "group_norm", "instance_norm", "layer_norm",
+      "sync_batch_norm"};
+  static const std::set<std::string> compare_ops = {
+      "equal",     "greater_equal", "greater_than", "less_equal", "less_than",
+      "logical_and", "logical_or",  "logical_xor",  "not_equal"};
+
+  auto first = [](const std::vector<std::string>& args) {
+    return args.size() == 1 ? args[0] : std::string();
+  };
+  const std::string& type = op.type();
+  std::vector<int64_t> x = GetVarShape(first(GetArguments(op.inputs(), "X")));
+  std::string out = first(GetArguments(op.outputs(), "Out"));
+  shape->clear();
+
+  if (unary_ops.find(type) != unary_ops.end()) {
+    *shape = x;
+  } else if (norm_ops.find(type) != norm_ops.end()) {
+    out = first(GetArguments(op.outputs(), "Y"));
+    *shape = x;
+  } else if (type.find("elementwise_") == 0 ||
+             compare_ops.find(type) != compare_ops.end()) {
+    std::vector<int64_t> y =
+        GetVarShape(first(GetArguments(op.inputs(), "Y")));
+    int64_t axis = -1;
+    if (OpHasAttr(op, "axis")) {
+      GetOpAttr(op, "axis", &axis);
+    }
+    if (x.empty() || y.empty()) {
+      return false;
+    }
+    if (axis == -1 || x.size() == y.size()) {
+      *shape = BroadcastShape(x, y);
+    } else if (y.size() < x.size()) {
+      *shape = x;
+    }
+  } else if (type == "conv2d" || type == "depthwise_conv2d" ||
+             type == "pool2d") {
+    std::string data_format = "NCHW";
+    std::string padding_algorithm = "EXPLICIT";
+    if (OpHasAttr(op, "data_format")) {
+      GetOpAttr(op, "data_format", &data_format);
+    }
+    if (OpHasAttr(op, "padding_algorithm")) {
+      GetOpAttr(op, "padding_algorithm", &padding_algorithm);
+    }
+    if (data_format != "NCHW" && data_format != "AnyLayout") {
+      return false;
+    }
+    std::vector<int64_t> kernel;
+    std::vector<int64_t> strides;
+    std::vector<int64_t> paddings;
+    std::vector<int64_t> dilations = {1, 1};
+    bool ceil_mode = false;
+    int64_t channels = -1;
+    if (type == "pool2d") {
+      bool global_pooling = false;
+      bool adaptive = false;
+      GetOpAttr(op, "ksize", &kernel);
+      GetOpAttr(op, "global_pooling", &global_pooling);
+      if (OpHasAttr(op, "adaptive")) {
+        GetOpAttr(op, "adaptive", &adaptive);
+      }
+      if (OpHasAttr(op, "ceil_mode")) {
+        GetOpAttr(op, "ceil_mode", &ceil_mode);
+      }
+      if (x.size() == 4 && (global_pooling || adaptive)) {
+        kernel = global_pooling ? std::vector<int64_t>(2, 1) : kernel;
+        if (kernel.size() == 2) {
+          *shape = {x[0], x[1], kernel[0], kernel[1]};
+        }
+        return !shape->empty();
+      }
+      channels = x.size() == 4 ? x[1] : -1;
+    } else {
+      x = GetVarShape(first(GetArguments(op.inputs(), "Input")));
+      std::vector<int64_t> filter =
+          GetVarShape(first(GetArguments(op.inputs(), "Filter")));
+      out = first(GetArguments(op.outputs(), "Output"));
+      if (filter.size() != 4) {
+        return false;
+      }
+      kernel = {filter[2], filter[3]};
+      channels = filter[0];
+      GetOpAttr(op, "dilations", &dilations);
+    }
+    GetOpAttr(op, "strides", &strides);
+    GetOpAttr(op, "paddings", &paddings);
+    if (x.size() != 4 || kernel.size() != 2 || strides.size() != 2 ||
+        dilations.size() != 2 ||
+        (paddings.size() != 2 && paddings.size() != 4)) {
+      return false;
+    }
+    *shape = {x[0], channels, -1, -1};
+    for (size_t i = 0; i < 2; ++i) {
+      int64_t pads = paddings.size() == 2
+                         ? 2 * paddings[i]
+                         : paddings[2 * i] + paddings[2 * i + 1];
+      if (padding_algorithm == "SAME") {
+        (*shape)[i + 2] = x[i + 2] < 0 || strides[i] <= 0
+                              ? -1
+                              : (x[i + 2] + strides[i] - 1) / strides[i];
+        continue;
+      } else if (padding_algorithm == "VALID") {
+        pads = 0;
+      }
+      (*shape)[i + 2] = WindowOutputSize(x[i + 2], kernel[i], strides[i],
+                                         dilations[i], pads, ceil_mode);
+    }
+  } else if (type == "transpose2") {
+    std::vector<int64_t> perm;
+    GetOpAttr(op, "axis", &perm);
+    if (perm.size() != x.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < perm.size(); ++i) {
+      if (perm[i] < 0 || perm[i] >= static_cast<int64_t>(x.size())) {
+        return false;
+      }
+      shape->push_back(x[perm[i]]);
+    }
+  } else if (type == "matmul_v2") {
+    std::vector<int64_t> y =
+        GetVarShape(first(GetArguments(op.inputs(), "Y")));
+    bool trans_x = false;
+    bool trans_y = false;
+    GetOpAttr(op, "trans_x", &trans_x);
+    GetOpAttr(op, "trans_y", &trans_y);
+    if (x.size() < 2 || y.size() < 2) {
+      return false;
+    }
+    *shape = BroadcastShape(std::vector<int64_t>(x.begin(), x.end() - 2),
+                            std::vector<int64_t>(y.begin(), y.end() - 2));
+    shape->push_back(trans_x ? x[x.size() - 1] : x[x.size() - 2]);
+    shape->push_back(trans_y ? y[y.size() - 2] : y[y.size() - 1]);
+  } else if (type == "concat") {
+    if (!GetArguments(op.inputs(), "AxisTensor").empty()) {
+      return false;
+    }
+    int64_t axis = 0;
+    GetOpAttr(op, "axis", &axis);
+    for (auto& name : GetArguments(op.inputs(), "X")) {
+      std::vector<int64_t> input = GetVarShape(name);
+      if (input.empty() || (!shape->empty() && input.size() != shape->size())) {
+        return false;
+      }
+      if (axis < 0) {
+        axis += input.size();
+      }
+      if (axis < 0 || axis >= static_cast<int64_t>(input.size())) {
+        return false;
+      }
+      if (shape->empty()) {
+        *shape = input;
+        continue;
+      }
+      for (size_t i = 0; i < input.size(); ++i) {
+        if (static_cast<int64_t>(i) == axis) {
+          (*shape)[i] = (*shape)[i] < 0 || input[i] < 0
+                            ? -1
+                            : (*shape)[i] + input[i];
+        } else if ((*shape)[i] < 0) {
+          (*shape)[i] = input[i];
+        }
+      }
+    }
+  } else if (type == "reshape2") {
+    if (!GetArguments(op.inputs(), "Shape").empty() ||
+        !GetArguments(op.inputs(), "ShapeTensor").empty()) {
+      return false;
+    }
+    GetOpAttr(op, "shape", shape);
+    int64_t numel = 1;
+    for (auto& dim : x) {
+      numel = dim < 0 || numel < 0 ? -1 : numel * dim;
+    }
+    int64_t known = 1;
+    int64_t unknown_index = -1;
+    for (size_t i = 0; i < shape->size(); ++i) {
+      if ((*shape)[i] == 0) {
+        (*shape)[i] = i < x.size() ? x[i] : -1;
+      } else if ((*shape)[i] == -1) {
+        unknown_index = i;
+        continue;
+      }
+      known = (*shape)[i] < 0 || known < 0 ? -1 : known * (*shape)[i];
+    }
+    if (unknown_index >= 0 && numel >= 0 && known > 0) {
+      (*shape)[unknown_index] = numel / known;
+    }
+  } else if (type == "flatten_contiguous_range") {
+    int64_t start_axis = 1;
+    int64_t stop_axis = -1;
+    GetOpAttr(op, "start_axis", &start_axis);
+    GetOpAttr(op, "stop_axis", &stop_axis);
+    int64_t rank = x.size();
+    start_axis = start_axis < 0 ? start_axis + rank : start_axis;
+    stop_axis = stop_axis < 0 ? stop_axis + rank : stop_axis;
+    if (rank == 0 || start_axis < 0 || stop_axis >= rank ||
+        start_axis > stop_axis) {
+      return false;
+    }
+    int64_t numel = 1;
+    for (int64_t i = 0; i < rank; ++i) {
+      if (i < start_axis || i > stop_axis) {
+        shape->push_back(x[i]);
+        continue;
+      }
+      numel = x[i] < 0 || numel < 0 ? -1 : numel * x[i];
+      if (i == stop_axis) {
+        shape->push_back(numel);
+      }
+    }
+  }
+  *output = out;
+  return !out.empty() && !shape->empty();
+}
+
+bool PaddleParser::SetInputShapes(
+    const std::map<std::string, std::vector<int64_t>>& input_shapes) {
+  for (auto& item : input_shapes) {
+    auto iter = std::find_if(
+        inputs.begin(), inputs.end(),
+        [&item](const TensorInfo& info) { return info.name == item.first; });
+    if (iter == inputs.end()) {
+      P2OLogger() << "[ERROR] Cannot find input: " << item.first
+                  << " in the model." << std::endl;
+      return false;
+    }
+    if (iter->shape.size() != item.second.size()) {
+      P2OLogger() << "[ERROR] The rank of input: " << item.first << " is "
+                  << iter->shape.size() << ", but the specified shape has "
+                  << item.second.size() << " dimensions." << std::endl;
+      return false;
+    }
+    for (size_t i = 0; i < item.second.size(); ++i) {
+      // The negative dimension means keeping it as recorded in the model
+      if (item.second[i] == 0 ||
+          (item.second[i] > 0 && iter->shape[i] >= 0 &&
+           iter->shape[i] != item.second[i])) {
+        P2OLogger() << "[ERROR] The specified dimension " << i
+                    << " of input: " << item.first << " is " << item.second[i]
+                    << ", which conflicts with " << iter->shape[i]
+                    << " in the model." << std::endl;
+        return false;
+      }
+    }
+  }
+  if (input_shapes.empty()) {
+    return true;
+  }
+
+  for (auto& item : input_shapes) {
+    RefineVarShape(item.first, item.second);
+  }
+  // Propagate the static dimensions through the common operators, the shapes
+  // of other operators' outputs are kept as recorded in the program
+  for (auto i = 0; i < prog->blocks(0).ops_size(); ++i) {
+    std::string output;
+    std::vector<int64_t> shape;
+    if (InferShape(prog->blocks(0).ops(i), &output, &shape)) {
+      RefineVarShape(output, shape);
+    }
+  }
+  GetGlobalBlockInputOutputInfo();
+  return true;
+}
+
 int32_t PaddleDataTypeSize(int32_t paddle_dtype) {
   Assert(paddle_dtype != FP16, "Float16 is not supported.");
   if (paddle_dtype == P2ODataType::BOOL) {
@@ -650,6 +1178,8 @@ int32_t PaddleDataTypeSize(int32_t paddle_dtype) {
     return sizeof(double);
   } else if (paddle_dtype == P2ODataType::UINT8) {
     return sizeof(uint8_t);
+  } else if (paddle_dtype == P2ODataType::INT8) {
+    return sizeof(int8_t);
   } else {
     Assert(false, "Unexpected data type: " + std::to_string(paddle_dtype));
   }
@@ -16,6 +16,7 @@
 #include <algorithm>
 #include <cassert>
 #include <numeric>
+#include <set>
 #include <type_traits>
 
 #include "paddle2onnx/proto/p2o_paddle.pb.h"
@@ -23,7 +24,7 @@
 
 namespace paddle2onnx {
 
-enum P2ODataType { BOOL, INT16, INT32, INT64, FP16, FP32, FP64, X7, X8, X9, X10, X11, X12, X13, X14, X15, X16, X17, X18, X19, UINT8};
+enum P2ODataType { BOOL, INT16, INT32, INT64, FP16, FP32, FP64, X7, X8, X9, X10, X11, X12, X13, X14, X15, X16, X17, X18, X19, UINT8, INT8};
 int32_t PaddleDataTypeSize(int32_t paddle_dtype);
 
 struct TensorInfo {
@@ -60,7 +61,7 @@ struct Weight {
     }
   }
   template <typename T>
-  void get(std::vector<T>* data) {
+  void get(std::vector<T>* data) const {
     int64_t nums = std::accumulate(std::begin(shape), std::end(shape), 1,
                                    std::multiplies<int64_t>());
     data->resize(nums);
@@ -91,6 +92,9 @@ class PaddleParser {
   int NumOfBlocks() const;
   int NumOfOps(int block_idx) const;
   bool HasNms() const { return _has_nms; }
+  // The number of operators removed while loading, which are not related to
+  // the fetch targets
+  int64_t NumOfDeadOps() const { return _num_dead_ops; }
   const framework::proto::OpDesc& GetOpDesc(int32_t block_idx,
                                             int32_t op_idx) const;
 
@@ -122,8 +126,24 @@ class PaddleParser {
   void GetOpAttr(const paddle2onnx::framework::proto::OpDesc& op,
                  const std::string& name, std::vector<double>* res) const;
 
+  // Override the shapes of feed variables, and propagate the static
+  // dimensions to the variables of global block, the negative dimensions are
+  // kept as dynamic, return false if the shapes conflict with the model
+  bool SetInputShapes(
+      const std::map<std::string, std::vector<int64_t>>& input_shapes);
+
   bool IsConstantTensor(const int64_t& block_idx,
                         const std::string& tensor_name) const;
+  // Get the operators(block index, operator index) reading the parameter, the
+  // operator appears as many times as the parameter is read by it
+  std::vector<std::pair<int64_t, int64_t>> GetParamConsumers(
+      const std::string& name) const;
+  // Whether the row of padding_idx in the parameter is zeroed while loading,
+  // which happens while the parameter is only read by lookup_table operators
+  // with the same padding_idx
+  bool IsZeroPaddingParam(const std::string& name) const {
+    return _zero_padding_params.find(name) != _zero_padding_params.end();
+  }
   template <typename T>
   bool TryGetTensorValue(const int64_t& block_id,
                          const std::string& tensor_name,
@@ -139,15 +159,31 @@ class PaddleParser {
       const std::string& name,
       const paddle2onnx::framework::proto::BlockDesc& block) const;
   void GetGlobalBlockInputOutputInfo();
+  std::vector<int64_t> GetVarShape(const std::string& name) const;
+  void RefineVarShape(const std::string& name,
+                      const std::vector<int64_t>& shape);
+  bool InferShape(const paddle2onnx::framework::proto::OpDesc& op,
+                  std::string* output, std::vector<int64_t>* shape) const;
   bool GetParamNames(std::vector<std::string>* var_names);
   bool LoadProgram(const std::string& model, bool from_memory_buffer);
   bool LoadParams(const std::string& path);
   bool LoadParamsFromMemoryBuffer(const std::string& buffer);
+  // Remove the operators of global block which are not reachable from the
+  // fetch targets, and clear the sub blocks which are not used by the kept
+  // operators, the parameters only used by the removed operators are
+  // recorded in _unused_params and skipped while loading
+  void RemoveDeadOps();
+  void ZeroPaddingParams();
   // This is a trick flag
   // While there's a nms operator in paddle model,
   // the shape inference of paddle is not correct
   bool _has_nms = false;
+  std::set<std::string> _unused_params;
+  int64_t _num_dead_ops = 0;
   std::vector<std::unordered_map<std::string, int64_t>> _constant_ops;
+  std::map<std::string, std::vector<std::pair<int64_t, int64_t>>>
+      _param_consumers;
+  std::set<std::string> _zero_padding_params;
 };
 
 template <typename T>
@@ -148,6 +148,7 @@ class APIOnnx(object):
         self.input_feed = {}
         self.input_spec_shape = input_spec_shape
         self.input_dtype = []
+        self.export_options = None
 
         if isfunction(self.func):
             # self._func = self.BuildFunc(self.func, **self.kwargs_dict_dygraph["params_group1"])
@@ -204,6 +205,13 @@ class APIOnnx(object):
                     shape=shape, dtype=self.input_dtype[i], name=str(i)))
             i += 1
 
+    def set_export_options(self, **options):
+        """
+        export with the c++ converter and the options of c_paddle_to_onnx,
+        e.g loop_unroll_threshold, export_fp16_model, weight_quantize_type
+        """
+        self.export_options = options
+
     def _mkdir(self):
         """
         make dir to save all
@@ -225,6 +233,23 @@ class APIOnnx(object):
         #        paddle.jit.save(instance, "model/model", input_spec=self.input_spec)
         #        import sys
         #        sys.exit(0)
+        if self.export_options is not None:
+            from paddle2onnx.command import c_paddle_to_onnx
+            save_path = os.path.join(self.pwd, self.name,
+                                     self.name + '_' + str(ver))
+            paddle.jit.save(instance, save_path, input_spec=self.input_spec)
+            params_file = save_path + ".pdiparams"
+            if not os.path.exists(params_file):
+                params_file = ""
+            c_paddle_to_onnx(
+                model_file=save_path + ".pdmodel",
+                params_file=params_file,
+                save_file=save_path + ".onnx",
+                opset_version=ver,
+                auto_upgrade_opset=False,
+                verbose=False,
+                **self.export_options)
+            return
         paddle.onnx.export(
             instance,
             os.path.join(self.pwd, self.name, self.name + '_' + str(ver)),
@@ -252,6 +277,15 @@ class APIOnnx(object):
         ort_outs = sess.run(output_names=None, input_feed=self.input_feed)
         return ort_outs
 
+    def load_onnx_model(self, ver):
+        """
+        load the exported onnx model to check the graph
+        """
+        import onnx
+        return onnx.load(
+            os.path.join(self.pwd, self.name, self.name + '_' + str(ver) +
+                         '.onnx'))
+
     def add_kwargs_to_dict(self, group_name, **kwargs):
         """
         params dict tool
@@ -0,0 +1,79 @@
+# Copyright (c) 2022  PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License"
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import paddle
+from onnxbase import APIOnnx
+from onnxbase import randtool
+
+
+class Net(paddle.nn.Layer):
+    """
+    simple Net
+    """
+
+    def __init__(self, bias_attr=None):
+        super(Net, self).__init__()
+        self._conv = paddle.nn.Conv2D(
+            in_channels=4, out_channels=8, kernel_size=3, bias_attr=bias_attr)
+        self._scale = self.create_parameter(
+            shape=[8],
+            dtype='float32',
+            default_initializer=paddle.nn.initializer.Uniform(0.5, 1.5))
+        self._shift = self.create_parameter(
+            shape=[8],
+            dtype='float32',
+            default_initializer=paddle.nn.initializer.Uniform(-1, 1))
+
+    def forward(self, inputs):
+        """
+        forward
+        """
+        x = self._conv(inputs)
+        x = paddle.scale(x, scale=2.0, bias=0.5)
+        x = paddle.fluid.layers.elementwise_mul(x, self._scale, axis=1)
+        x = paddle.fluid.layers.elementwise_add(x, self._shift, axis=1)
+        x = paddle.scale(x, scale=0.5)
+        return x
+
+
+def test_Conv2D_Affine():
+    """
+    api: paddle.Conv2D_Affine
+    op version: 9, 11
+    """
+    op = Net()
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'Conv2D_Affine', [9, 11], ops=['conv2d'])
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(
+            randtool("float", -1, 1, [3, 4, 10, 10]).astype('float32')))
+    obj.run()
+
+
+def test_Conv2D_Affine_without_bias():
+    """
+    api: paddle.Conv2D_Affine
+    op version: 9, 11
+    """
+    op = Net(bias_attr=False)
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'Conv2D_Affine', [9, 11], ops=['conv2d'])
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(
+            randtool("float", -1, 1, [3, 4, 10, 10]).astype('float32')))
+    obj.run()
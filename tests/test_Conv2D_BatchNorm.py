@@ -0,0 +1,122 @@
+# Copyright (c) 2022  PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License"
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import paddle
+from onnxbase import APIOnnx
+from onnxbase import randtool
+
+
+class Net(paddle.nn.Layer):
+    """
+    simple Net
+    """
+
+    def __init__(self, groups=1, transpose=False, bias_attr=None):
+        super(Net, self).__init__()
+        if transpose:
+            self._conv = paddle.nn.Conv2DTranspose(
+                in_channels=4,
+                out_channels=8,
+                kernel_size=3,
+                groups=groups,
+                bias_attr=bias_attr)
+        else:
+            self._conv = paddle.nn.Conv2D(
+                in_channels=4,
+                out_channels=8,
+                kernel_size=3,
+                groups=groups,
+                bias_attr=bias_attr)
+        self._bn = paddle.nn.BatchNorm2D(num_features=8)
+        self._bn.weight.set_value(
+            randtool("float", 0.5, 1.5, [8]).astype('float32'))
+        self._bn.bias.set_value(
+            randtool("float", -1, 1, [8]).astype('float32'))
+        self._bn._mean.set_value(
+            randtool("float", -1, 1, [8]).astype('float32'))
+        self._bn._variance.set_value(
+            randtool("float", 0.5, 2, [8]).astype('float32'))
+
+    def forward(self, inputs):
+        """
+        forward
+        """
+        x = self._conv(inputs)
+        x = self._bn(x)
+        return x
+
+
+def test_Conv2D_BatchNorm():
+    """
+    api: paddle.Conv2D_BatchNorm
+    op version: 9
+    """
+    op = Net()
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'Conv2D_BatchNorm', [9], ops=['conv2d'])
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(
+            randtool("float", -1, 1, [3, 4, 10, 10]).astype('float32')))
+    obj.run()
+
+
+def test_Conv2D_BatchNorm_without_bias():
+    """
+    api: paddle.Conv2D_BatchNorm
+    op version: 9
+    """
+    op = Net(bias_attr=False)
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'Conv2D_BatchNorm', [9], ops=['conv2d'])
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(
+            randtool("float", -1, 1, [3, 4, 10, 10]).astype('float32')))
+    obj.run()
+
+
+def test_DepthwiseConv2D_BatchNorm():
+    """
+    api: paddle.Conv2D_BatchNorm
+    op version: 9
+    """
+    op = Net(groups=4)
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'Conv2D_BatchNorm', [9], ops=['conv2d'])
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(
+            randtool("float", -1, 1, [3, 4, 10, 10]).astype('float32')))
+    obj.run()
+
+
+def test_Conv2DTranspose_BatchNorm():
+    """
+    api: paddle.Conv2DTranspose_BatchNorm
+    op version: 9
+    """
+    op = Net(groups=2, transpose=True)
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'Conv2DTranspose_BatchNorm', [9],
+                  ops=['conv2d_transpose'])
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(
+            randtool("float", -1, 1, [3, 4, 10, 10]).astype('float32')))
+    obj.run()
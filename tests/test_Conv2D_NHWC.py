@@ -0,0 +1,64 @@
+# Copyright (c) 2022  PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License"
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import paddle
+from onnxbase import APIOnnx
+from onnxbase import randtool
+
+
+class Net(paddle.nn.Layer):
+    """
+    simple Net
+    """
+
+    def __init__(self):
+        super(Net, self).__init__()
+        self._conv1 = paddle.nn.Conv2D(
+            in_channels=4, out_channels=8, kernel_size=3, data_format='NHWC')
+        self._bn = paddle.nn.BatchNorm2D(num_features=8, data_format='NHWC')
+        self._pool = paddle.nn.MaxPool2D(
+            kernel_size=2, stride=2, data_format='NHWC')
+        self._conv2 = paddle.nn.Conv2D(
+            in_channels=8, out_channels=8, kernel_size=1, data_format='NHWC')
+        self._bias = self.create_parameter(shape=[8], dtype='float32')
+
+    def forward(self, inputs):
+        """
+        forward
+        """
+        x = self._conv1(inputs)
+        x = self._bn(x)
+        x = paddle.nn.functional.relu(x)
+        x = self._pool(x)
+        y = self._conv2(x)
+        x = paddle.nn.functional.relu(x + y + self._bias)
+        x = paddle.nn.functional.interpolate(
+            x, scale_factor=2, mode='nearest', data_format='NHWC')
+        return x
+
+
+def test_Conv2D_NHWC():
+    """
+    api: paddle.Conv2D_NHWC
+    op version: 11, 12
+    """
+    op = Net()
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'Conv2D_NHWC', [11, 12])
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(
+            randtool("float", -1, 1, [3, 10, 10, 4]).astype('float32')))
+    obj.run()
@@ -33,6 +33,24 @@ class Net(paddle.nn.Layer):
         return x
 
 
+class SharedBiasNet(paddle.nn.Layer):
+    """
+    Net with parameter read by two elementwise ops broadcasting from axis 1
+    """
+
+    def __init__(self):
+        super(SharedBiasNet, self).__init__()
+        self._bias = self.create_parameter(shape=[8], dtype='float32')
+
+    def forward(self, inputs):
+        """
+        forward
+        """
+        x = paddle.fluid.layers.elementwise_add(inputs, self._bias, axis=1)
+        x = paddle.fluid.layers.elementwise_mul(x, self._bias, axis=1)
+        return x
+
+
 def test_add_9():
     """
     api: paddle.add
@@ -95,3 +113,19 @@ def test_add_12():
         paddle.to_tensor(randtool("float", -1, 1, [3, 10]).astype('float32')),
         paddle.to_tensor(randtool("float", 0, 1, [3, 10]).astype('float32')))
     obj.run()
+
+
+def test_add_shared_parameter():
+    """
+    api: paddle.fluid.layers.elementwise_add
+    op version: 9, 11, 12
+    """
+    op = SharedBiasNet()
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'add_shared', [9, 11, 12])
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(
+            randtool("float", -1, 1, [3, 8, 4, 4]).astype('float32')))
+    obj.run()
@@ -68,5 +68,49 @@ class TestSetValueConvert(OPConvertAutoScanTest):
         self.run_and_statis(max_examples=30)
 
 
+class NetMultiAxes(BaseNet):
+    """
+    simple Net
+    """
+
+    def forward(self, inputs):
+        """
+        forward
+        """
+        x = inputs + 1
+        x[:, 1:3, ::2] = 3
+        x[-1, :, 1] = 5
+        return x
+
+
+class TestSetValueMultiAxesConvert(OPConvertAutoScanTest):
+    """
+    api: set_value
+    OPset version: 12, 13, 15
+    """
+
+    def sample_convert_config(self, draw):
+        input_shape = draw(
+            st.lists(
+                st.integers(
+                    min_value=3, max_value=10), min_size=3, max_size=4))
+
+        dtype = draw(st.sampled_from(["float32"]))
+        config = {
+            "op_names": ["set_value"],
+            "test_data_shapes": [input_shape],
+            "test_data_types": [[dtype]],
+            "opset_version": [12, 13, 14, 15],
+            "input_spec_shape": [],
+        }
+
+        models = NetMultiAxes(config)
+
+        return (config, models)
+
+    def test(self):
+        self.run_and_statis(max_examples=30)
+
+
 if __name__ == "__main__":
     unittest.main()
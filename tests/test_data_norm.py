@@ -0,0 +1,98 @@
+# Copyright (c) 2021  PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License"
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+import os
+import numpy as np
+import onnx
+import paddle
+from onnxruntime import InferenceSession
+from paddle2onnx.command import c_paddle_to_onnx
+
+
+def data_norm_api(name, slot_dim, ver_list):
+    """
+    export data_norm of a static program, and compare the results of
+    onnxruntime and PaddlePaddle
+    """
+    np.random.seed(33)
+    x = np.random.rand(4, 8).astype('float32')
+    # The slots whose show number(the first value of slot) is zero
+    x[0, 0] = 0.0
+    x[2, 4] = 0.0
+
+    paddle.enable_static()
+    main_program = paddle.static.Program()
+    startup_program = paddle.static.Program()
+    with paddle.static.program_guard(main_program, startup_program):
+        inputs = paddle.static.data(name='x', shape=[-1, 8], dtype='float32')
+        out = paddle.static.nn.data_norm(
+            input=inputs,
+            param_attr={
+                "batch_size": 1e4,
+                "batch_sum": 2e3,
+                "batch_square": 4e4
+            },
+            slot_dim=slot_dim)
+    exe = paddle.static.Executor(paddle.CPUPlace())
+    exe.run(startup_program)
+    expect = exe.run(main_program, feed={'x': x}, fetch_list=[out])[0]
+    save_path = os.path.join(os.getcwd(), name, name)
+    paddle.static.save_inference_model(
+        save_path, [inputs], [out], exe, program=main_program)
+    paddle.disable_static()
+
+    models = {}
+    for ver in ver_list:
+        save_file = save_path + '_' + str(ver) + '.onnx'
+        c_paddle_to_onnx(
+            model_file=save_path + ".pdmodel",
+            params_file=save_path + ".pdiparams",
+            save_file=save_file,
+            opset_version=ver,
+            auto_upgrade_opset=False,
+            verbose=False)
+        result = InferenceSession(save_file).run(None, {'x': x})[0]
+        assert np.allclose(result, expect, atol=1e-6, rtol=1e-5)
+        models[ver] = onnx.load(save_file)
+    return models
+
+
+def op_types(model):
+    """
+    operator types of the graph
+    """
+    return set(node.op_type for node in model.graph.node)
+
+
+def test_data_norm():
+    """
+    api: paddle.static.nn.data_norm
+    op version: 7, 11, 13
+    """
+    models = data_norm_api('data_norm', -1, [7, 11, 13])
+    # The mean and scale are computed while exporting
+    for model in models.values():
+        types = op_types(model)
+        assert "Div" not in types and "Sqrt" not in types
+
+
+def test_data_norm_slot_dim():
+    """
+    api: paddle.static.nn.data_norm
+    op version: 7, 11, 13
+    """
+    models = data_norm_api('data_norm_slot_dim', 2, [7, 11, 13])
+    for model in models.values():
+        types = op_types(model)
+        assert "Div" not in types and "Sqrt" not in types
+        assert "Less" in types
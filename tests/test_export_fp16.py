@@ -0,0 +1,129 @@
+# Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License"
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import onnx
+import paddle
+from onnx import TensorProto
+from onnxbase import APIOnnx
+from onnxbase import randtool
+
+
+def tensor_types(model):
+    """
+    data types of all the tensors in the exported model
+    """
+    model = onnx.shape_inference.infer_shapes(model)
+    graph = model.graph
+    types = {}
+    for info in list(graph.input) + list(graph.value_info) + list(
+            graph.output):
+        types[info.name] = info.type.tensor_type.elem_type
+    for tensor in graph.initializer:
+        types[tensor.name] = tensor.data_type
+    for node in graph.node:
+        if node.op_type == "Constant":
+            types[node.output[0]] = node.attribute[0].t.data_type
+    return types
+
+
+def check_types(model, weight_types):
+    """
+    the weights of Conv/Gemm/MatMul are in `weight_types`, and the operators
+    of layer_norm and softmax in keep-list are computed in float32
+    """
+    types = tensor_types(model)
+    nodes = list(model.graph.node)
+    for node in nodes:
+        if node.op_type in weight_types:
+            assert types[node.input[1]] == weight_types[node.op_type], \
+                "{} has weight in type {}".format(node.op_type,
+                                                  types[node.input[1]])
+        if node.op_type in ["Softmax", "ReduceMean"]:
+            assert types[node.input[0]] == TensorProto.FLOAT, \
+                "{} has input in type {}".format(node.op_type,
+                                                 types[node.input[0]])
+    op_types = [node.op_type for node in nodes]
+    assert "Conv" in op_types and "Softmax" in op_types
+
+
+class Net(paddle.nn.Layer):
+    """
+    conv, pool and linear in float16, layer_norm and softmax in keep-list
+    """
+
+    def __init__(self):
+        super(Net, self).__init__()
+        self._conv = paddle.nn.Conv2D(3, 8, 3, padding=1)
+        self._pool = paddle.nn.AdaptiveAvgPool2D(4)
+        self._linear = paddle.nn.Linear(128, 32)
+        self._layer_norm = paddle.nn.LayerNorm(32)
+
+    def forward(self, inputs):
+        """
+        forward
+        """
+        x = paddle.nn.functional.relu(self._conv(inputs))
+        x = paddle.flatten(self._pool(x), start_axis=1)
+        x = self._layer_norm(self._linear(x))
+        return paddle.nn.functional.softmax(x)
+
+
+def test_export_fp16():
+    """
+    api: export_fp16_model
+    op version: 11, 13, 15
+    """
+    op = Net()
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'export_fp16', [11, 13, 15], delta=1e-3, rtol=1e-2)
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(
+            randtool("float", -1, 1, [2, 3, 16, 16]).astype('float32')))
+    obj.set_export_options(export_fp16_model=True)
+    obj.run()
+    for ver in [11, 13, 15]:
+        check_types(
+            obj.load_onnx_model(ver), {
+                "Conv": TensorProto.FLOAT16,
+                "Gemm": TensorProto.FLOAT16,
+                "MatMul": TensorProto.FLOAT16
+            })
+
+
+def test_export_fp16_keep_ops():
+    """
+    api: export_fp16_model
+    op version: 13
+    """
+    op = Net()
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'export_fp16', [13], delta=1e-3, rtol=1e-2)
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(
+            randtool("float", -1, 1, [2, 3, 16, 16]).astype('float32')))
+    # matmul_v2 of linear stays in float32 too
+    obj.set_export_options(
+        export_fp16_model=True,
+        fp16_keep_ops=["layer_norm", "softmax", "matmul_v2"])
+    obj.run()
+    check_types(
+        obj.load_onnx_model(13), {
+            "Conv": TensorProto.FLOAT16,
+            "Gemm": TensorProto.FLOAT,
+            "MatMul": TensorProto.FLOAT
+        })
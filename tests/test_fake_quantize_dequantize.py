@@ -0,0 +1,89 @@
+# Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License"
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import paddle
+from paddle.fluid.contrib.slim.quantization import ImperativeQuantAware
+from onnxbase import APIOnnx
+from onnxbase import randtool
+
+
+class Net(paddle.nn.Layer):
+    """
+    conv and linear to be quantized
+    """
+
+    def __init__(self):
+        super(Net, self).__init__()
+        self._conv = paddle.nn.Conv2D(3, 8, 3, padding=1)
+        self._linear = paddle.nn.Linear(8 * 8 * 8, 10)
+
+    def forward(self, inputs):
+        """
+        forward
+        """
+        x = paddle.nn.functional.relu(self._conv(inputs))
+        x = paddle.nn.functional.max_pool2d(x, 2)
+        return self._linear(paddle.flatten(x, start_axis=1))
+
+
+def quantized_net(weight_quantize_type, data):
+    """
+    insert the fake quantize-dequantize operators, and calibrate the moving
+    average scales of activations
+    """
+    net = Net()
+    quanter = ImperativeQuantAware(
+        weight_quantize_type=weight_quantize_type,
+        activation_quantize_type='moving_average_abs_max')
+    quanter.quantize(net)
+    net.train()
+    for _ in range(5):
+        net(data)
+    net.eval()
+    return net
+
+
+def test_fake_quantize_dequantize_abs_max():
+    """
+    api: fake_quantize_dequantize_abs_max,
+        fake_quantize_dequantize_moving_average_abs_max
+    op version: 10, 13, 15
+    """
+    data = paddle.to_tensor(
+        randtool("float", -1, 1, [2, 3, 16, 16]).astype('float32'))
+    op = quantized_net('abs_max', data)
+    # the values may differ by a quantization step while rounding
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(
+        op, 'fake_quantize_dequantize', [10, 13, 15], delta=5e-2, rtol=5e-2)
+    obj.set_input_data("input_data", data)
+    obj.set_export_options()
+    obj.run()
+
+
+def test_fake_channel_wise_quantize_dequantize_abs_max():
+    """
+    api: fake_channel_wise_quantize_dequantize_abs_max
+    op version: 13, 15
+    """
+    data = paddle.to_tensor(
+        randtool("float", -1, 1, [2, 3, 16, 16]).astype('float32'))
+    op = quantized_net('channel_wise_abs_max', data)
+    # the values may differ by a quantization step while rounding
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(
+        op, 'fake_quantize_dequantize', [13, 15], delta=5e-2, rtol=5e-2)
+    obj.set_input_data("input_data", data)
+    obj.set_export_options()
+    obj.run()
@@ -0,0 +1,102 @@
+# Copyright (c) 2021  PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License"
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+import paddle
+from onnxbase import APIOnnx
+from onnxbase import randtool
+
+
+class Net(paddle.nn.Layer):
+    """
+    simple Net
+    """
+
+    def __init__(self):
+        super(Net, self).__init__()
+
+    def forward(self, inputs):
+        """
+        forward
+        """
+        y = paddle.arange(0, 12, 1, dtype='float32')
+        y = paddle.tile(paddle.reshape(y, [3, 4]), [2, 1])
+        y = y * paddle.full([6, 4], 2.0)
+        x = inputs + y
+        return paddle.reshape(x, paddle.shape(inputs))
+
+
+class LargeNet(paddle.nn.Layer):
+    """
+    simple Net
+    """
+
+    def __init__(self):
+        super(LargeNet, self).__init__()
+
+    def forward(self, inputs):
+        """
+        forward
+        """
+        y = paddle.arange(0, 256, 1, dtype='float32')
+        y = paddle.tile(paddle.reshape(y, [1, 256]), [512, 1])
+        return inputs + y
+
+
+def op_types(model):
+    """
+    operator types of the graph except Constant
+    """
+    return set(node.op_type for node in model.graph.node
+               if node.op_type != "Constant")
+
+
+def test_fold_constant():
+    """
+    api: paddle.arange, paddle.tile, paddle.shape
+    op version: 11, 13
+    """
+    op = Net()
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'fold_constant', [11, 13])
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(randtool("float", -1, 1, [6, 4]).astype('float32')))
+    obj.set_export_options(enable_optimize=True)
+    obj.run()
+    # Range, Tile, Mul and Shape of the static input are evaluated while
+    # exporting
+    for ver in [11, 13]:
+        types = op_types(obj.load_onnx_model(ver))
+        assert types.issubset(set(["Add", "Reshape"])), types
+
+
+def test_fold_constant_size_limit():
+    """
+    api: paddle.arange, paddle.tile
+    op version: 11, 13
+    """
+    op = LargeNet()
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'fold_constant_size_limit', [11, 13])
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(
+            randtool("float", -1, 1, [512, 256]).astype('float32')))
+    obj.set_export_options(enable_optimize=True)
+    obj.run()
+    # The result of Tile is larger than the limit, so it is not folded
+    for ver in [11, 13]:
+        types = op_types(obj.load_onnx_model(ver))
+        assert "Tile" in types and "Range" not in types
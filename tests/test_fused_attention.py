@@ -0,0 +1,107 @@
+# Copyright (c) 2021  PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License"
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+import numpy as np
+import paddle
+from onnxbase import APIOnnx
+from onnxbase import randtool
+
+
+class Net(paddle.nn.Layer):
+    """
+    simple Net
+    """
+
+    def __init__(self, hidden_size=64, num_heads=4):
+        super(Net, self).__init__()
+        self.num_heads = num_heads
+        self.head_dim = hidden_size // num_heads
+        self.hidden_size = hidden_size
+        self.q_proj = paddle.nn.Linear(hidden_size, hidden_size)
+        self.k_proj = paddle.nn.Linear(hidden_size, hidden_size)
+        self.v_proj = paddle.nn.Linear(hidden_size, hidden_size)
+
+    def split_heads(self, x):
+        """
+        [B, S, H * D] -> [B, H, S, D]
+        """
+        x = paddle.reshape(x, [0, 0, self.num_heads, self.head_dim])
+        return paddle.transpose(x, [0, 2, 1, 3])
+
+    def forward(self, inputs, attn_mask):
+        """
+        forward
+        """
+        q = self.split_heads(self.q_proj(inputs))
+        k = self.split_heads(self.k_proj(inputs))
+        v = self.split_heads(self.v_proj(inputs))
+        product = paddle.matmul(q, k, transpose_y=True)
+        product = paddle.scale(product, scale=self.head_dim**-0.5)
+        product = product + attn_mask
+        weights = paddle.nn.functional.softmax(product)
+        out = paddle.matmul(weights, v)
+        out = paddle.transpose(out, [0, 2, 1, 3])
+        return paddle.reshape(out, [0, 0, self.hidden_size])
+
+
+def op_types(model):
+    """
+    operator types of the graph
+    """
+    return [node.op_type for node in model.graph.node]
+
+
+def attention_api(name, enable_fused_attention):
+    """
+    export the attention block
+    """
+    op = Net()
+    op.eval()
+    mask = np.zeros([2, 1, 1, 8]).astype('float32')
+    mask[1, :, :, 6:] = -1e4
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, name, [11, 13], delta=1e-5, rtol=1e-5)
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(
+            randtool("float", -1, 1, [2, 8, 64]).astype('float32')),
+        paddle.to_tensor(mask))
+    obj.set_export_options(enable_fused_attention=enable_fused_attention)
+    obj.run()
+    return obj
+
+
+def test_fused_attention():
+    """
+    api: paddle.matmul, paddle.nn.functional.softmax
+    op version: 11, 13
+    """
+    obj = attention_api('fused_attention', True)
+    for ver in [11, 13]:
+        model = obj.load_onnx_model(ver)
+        types = op_types(model)
+        assert types.count("MultiHeadAttention") == 1
+        assert "Softmax" not in types
+        assert "com.microsoft" in [opset.domain for opset in model.opset_import]
+
+
+def test_fused_attention_disabled():
+    """
+    api: paddle.matmul, paddle.nn.functional.softmax
+    op version: 11, 13
+    """
+    obj = attention_api('fused_attention_disabled', False)
+    # The standard ONNX operators are exported by default
+    for ver in [11, 13]:
+        types = op_types(obj.load_onnx_model(ver))
+        assert "MultiHeadAttention" not in types and "Softmax" in types
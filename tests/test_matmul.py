@@ -33,6 +33,23 @@ class Net(paddle.nn.Layer):
         return x
 
 
+
+class WeightNet(paddle.nn.Layer):
+    """
+    simple Net with parameter as input Y
+    """
+
+    def __init__(self):
+        super(WeightNet, self).__init__()
+        self.weight = self.create_parameter(shape=[4, 10], dtype='float32')
+
+    def forward(self, inputs):
+        """
+        forward
+        """
+        x = paddle.matmul(inputs, self.weight, transpose_x=False, transpose_y=True)
+        return x
+
 def test_matmul_9():
     """
     api: paddle.matmul
@@ -95,3 +112,93 @@ def test_matmul_12():
         paddle.to_tensor(randtool("float", -1, 1, [3, 10]).astype('float32')),
         paddle.to_tensor(randtool("float", 0, 1, [3, 10]).astype('float32')))
     obj.run()
+
+
+def test_matmul_weight():
+    """
+    api: paddle.matmul
+    op version: 9, 11, 12
+    """
+    op = WeightNet()
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'matmul', [9, 11, 12])
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(randtool("float", -1, 1, [3, 10]).astype('float32')))
+    obj.run()
+
+
+class WeightNetV1(paddle.nn.Layer):
+    """
+    simple Net with parameter as input Y of matmul(v1)
+    """
+
+    def __init__(self):
+        super(WeightNetV1, self).__init__()
+        self.weight = self.create_parameter(shape=[4, 10], dtype='float32')
+
+    def forward(self, inputs):
+        """
+        forward
+        """
+        x = paddle.fluid.layers.matmul(
+            inputs, self.weight, transpose_x=True, transpose_y=True, alpha=0.5)
+        return x
+
+
+def test_matmul_weight_v1():
+    """
+    api: paddle.fluid.layers.matmul
+    op version: 9, 11, 12
+    """
+    op = WeightNetV1()
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'matmul', [9, 11, 12])
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(randtool("float", -1, 1, [10, 3]).astype('float32')))
+    obj.run()
+
+
+class SharedWeightNet(paddle.nn.Layer):
+    """
+    simple Net with parameter read by two matmul
+    """
+
+    def __init__(self):
+        super(SharedWeightNet, self).__init__()
+        self.weight = self.create_parameter(shape=[4, 10], dtype='float32')
+
+    def forward(self, inputs):
+        """
+        forward
+        """
+        x = paddle.matmul(inputs, self.weight, transpose_y=True)
+        x = paddle.matmul(x, self.weight)
+        return x
+
+
+def test_matmul_shared_weight():
+    """
+    api: paddle.matmul
+    op version: 9, 11, 12
+    """
+    op = SharedWeightNet()
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'matmul_shared', [9, 11, 12])
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(randtool("float", -1, 1, [3, 10]).astype('float32')))
+    obj.run()
+    # The shared weight is not transposed while exporting, Gemm transposes it
+    # while running instead
+    for ver in [11, 12]:
+        model = obj.load_onnx_model(ver)
+        trans_b = [
+            attr.i for node in model.graph.node if node.op_type == "Gemm"
+            for attr in node.attribute if attr.name == "transB"
+        ]
+        assert trans_b == [1]
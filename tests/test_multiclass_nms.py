@@ -0,0 +1,154 @@
+# Copyright (c) 2021  PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License"
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+import os
+import numpy as np
+import onnx
+import paddle
+from onnxruntime import InferenceSession
+from paddle.fluid.layer_helper import LayerHelper
+from paddle2onnx.command import c_paddle_to_onnx
+
+NUM_BOXES = 50
+NUM_CLASSES = 4
+
+
+def multiclass_nms(bboxes, scores, keep_top_k, background_label):
+    """
+    append the multiclass_nms3 operator to the static program
+    """
+    helper = LayerHelper('multiclass_nms3', **locals())
+    output = helper.create_variable_for_type_inference(dtype=bboxes.dtype)
+    index = helper.create_variable_for_type_inference(dtype='int32')
+    nms_rois_num = helper.create_variable_for_type_inference(dtype='int32')
+    helper.append_op(
+        type="multiclass_nms3",
+        inputs={'BBoxes': bboxes,
+                'Scores': scores},
+        attrs={
+            'background_label': background_label,
+            'score_threshold': 0.3,
+            'nms_top_k': NUM_BOXES,
+            'nms_threshold': 0.5,
+            'keep_top_k': keep_top_k,
+            'nms_eta': 1.0,
+            'normalized': True
+        },
+        outputs={'Out': output,
+                 'Index': index,
+                 'NmsRoisNum': nms_rois_num})
+    return output, index, nms_rois_num
+
+
+def canonical(out, index):
+    """
+    Paddle sorts the boxes of each image by class, the exported model sorts
+    them by score, so compare the boxes sorted by (image, class, score)
+    """
+    rows = np.concatenate([out, index.astype(out.dtype)], axis=1)
+    image = index[:, 0] // NUM_BOXES
+    return rows[np.lexsort((-rows[:, 1], rows[:, 0], image))]
+
+
+def nms_api(name, keep_top_k, background_label, batch_size, ver_list):
+    """
+    export multiclass_nms3 with dynamic batch size, and compare the results of
+    onnxruntime and PaddlePaddle
+    """
+    np.random.seed(33)
+    xy = np.random.rand(batch_size, NUM_BOXES, 2).astype('float32')
+    wh = np.random.rand(batch_size, NUM_BOXES, 2).astype('float32') * 0.3
+    feed = {
+        'bboxes': np.concatenate([xy, xy + wh], axis=-1),
+        'scores': np.random.rand(batch_size, NUM_CLASSES,
+                                 NUM_BOXES).astype('float32')
+    }
+
+    paddle.enable_static()
+    main_program = paddle.static.Program()
+    startup_program = paddle.static.Program()
+    with paddle.static.program_guard(main_program, startup_program):
+        bboxes = paddle.static.data(
+            name='bboxes', shape=[-1, NUM_BOXES, 4], dtype='float32')
+        scores = paddle.static.data(
+            name='scores', shape=[-1, NUM_CLASSES, NUM_BOXES], dtype='float32')
+        fetch_vars = multiclass_nms(bboxes, scores, keep_top_k,
+                                    background_label)
+    exe = paddle.static.Executor(paddle.CPUPlace())
+    exe.run(startup_program)
+    expect = exe.run(main_program,
+                     feed=feed,
+                     fetch_list=list(fetch_vars),
+                     return_numpy=False)
+    expect = [np.array(t) for t in expect]
+    save_path = os.path.join(os.getcwd(), name, name)
+    paddle.static.save_inference_model(
+        save_path, [bboxes, scores],
+        list(fetch_vars),
+        exe,
+        program=main_program)
+    paddle.disable_static()
+
+    models = {}
+    for ver in ver_list:
+        save_file = save_path + '_' + str(ver) + '.onnx'
+        c_paddle_to_onnx(
+            model_file=save_path + ".pdmodel",
+            params_file="",
+            save_file=save_file,
+            opset_version=ver,
+            auto_upgrade_opset=False,
+            verbose=False,
+            enable_experimental_op=True)
+        out, index, rois_num = InferenceSession(save_file).run(None, feed)
+        assert (rois_num == expect[2]).all()
+        assert np.allclose(
+            canonical(out, index),
+            canonical(expect[0], expect[1]),
+            atol=1e-6)
+        models[ver] = onnx.load(save_file)
+    return models
+
+
+def op_types(model):
+    """
+    operator types of the graph
+    """
+    return set(node.op_type for node in model.graph.node)
+
+
+def test_multiclass_nms_batch():
+    """
+    api: multiclass_nms3
+    op version: 11, 13
+    """
+    models = nms_api('multiclass_nms_batch', 10, -1, 3, [11, 13])
+    # keep_top_k is applied to each image
+    for model in models.values():
+        assert "CumSum" in op_types(model)
+
+
+def test_multiclass_nms_batch_background():
+    """
+    api: multiclass_nms3
+    op version: 11, 13
+    """
+    nms_api('multiclass_nms_batch_background', 5, 0, 2, [11, 13])
+
+
+def test_multiclass_nms_batch_without_keep_top_k():
+    """
+    api: multiclass_nms3
+    op version: 11, 13
+    """
+    nms_api('multiclass_nms_batch_without_keep_top_k', -1, -1, 2, [11, 13])
@@ -23,12 +23,12 @@ class Net(paddle.nn.Layer):
     simple Net
     """
 
-    def __init__(self):
+    def __init__(self, padding_idx=None):
         super(Net, self).__init__()
         self._embedding = paddle.nn.Embedding(
             num_embeddings=10,
             embedding_dim=3,
-            padding_idx=None,
+            padding_idx=padding_idx,
             sparse=True,
             weight_attr=None,
             name=None)
@@ -41,6 +41,33 @@ class Net(paddle.nn.Layer):
         return x
 
 
+class TiedNet(paddle.nn.Layer):
+    """
+    Net with the embedding weight shared by the output projection
+    """
+
+    def __init__(self, padding_idx=None):
+        super(TiedNet, self).__init__()
+        self._embedding = paddle.nn.Embedding(
+            num_embeddings=10, embedding_dim=3, padding_idx=padding_idx)
+
+    def forward(self, inputs):
+        """
+        forward
+        """
+        x = self._embedding(inputs)
+        return paddle.matmul(x, self._embedding.weight, transpose_y=True)
+
+
+def op_types(model):
+    """
+    operator types of the graph except Constant
+    """
+    return [
+        node.op_type for node in model.graph.node if node.op_type != "Constant"
+    ]
+
+
 def test_Embedding_base():
     """
     api: paddle.Embedding
@@ -54,3 +81,40 @@ def test_Embedding_base():
         "input_data",
         paddle.to_tensor(np.arange(3, 6).reshape((3, 1)).astype(np.int64)))
     obj.run()
+
+
+def test_Embedding_padding_idx():
+    """
+    api: paddle.Embedding
+    op version: 9, 10, 11, 12
+    """
+    op = Net(padding_idx=4)
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'nn_Embedding', [9, 10, 11, 12])
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(np.arange(3, 6).reshape((3, 1)).astype(np.int64)))
+    obj.run()
+    # The padding row of the weight is zeroed while exporting
+    for ver in [9, 10, 11, 12]:
+        assert "Where" not in op_types(obj.load_onnx_model(ver))
+
+
+def test_Embedding_padding_idx_shared_weight():
+    """
+    api: paddle.Embedding
+    op version: 7, 9, 11, 12
+    """
+    op = TiedNet(padding_idx=4)
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'nn_Embedding_tied', [7, 9, 11, 12])
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(np.arange(3, 6).reshape((3, 1)).astype(np.int64)))
+    obj.run()
+    # The shared weight is kept, the gathered padding rows are replaced by
+    # zeros instead
+    for ver in [9, 11, 12]:
+        assert "Where" in op_types(obj.load_onnx_model(ver))
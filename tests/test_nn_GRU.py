@@ -46,3 +46,46 @@ def test_GRU_base():
     obj.set_input_data("input_data",
                        paddle.randn((4, 23, 16)), paddle.randn((2, 4, 32)))
     obj.run()
+
+
+class BidirectNet(paddle.nn.Layer):
+    """
+    simple Net
+    """
+
+    def __init__(self):
+        super(BidirectNet, self).__init__()
+        self._gru = paddle.nn.GRU(16, 32, 2, direction="bidirect")
+
+    def forward(self, inputs):
+        """
+        forward
+        """
+        x, h = self._gru(inputs)
+        return x
+
+
+def test_GRU_bidirect():
+    """
+    api: paddle.nn.GRU
+    op version: 9, 11, 12
+    """
+    op = BidirectNet()
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'nn_GRU_bidirect', [9, 11, 12], delta=1e-5, rtol=1e-5)
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(
+            randtool("float", -1, 1, [4, 23, 16]).astype('float32')))
+    obj.set_export_options(enable_experimental_op=True)
+    obj.run()
+    # W, R and B are constants reordered while exporting
+    for ver in [9, 11, 12]:
+        model = obj.load_onnx_model(ver)
+        constants = set(node.output[0] for node in model.graph.node
+                        if node.op_type == "Constant")
+        constants.update(init.name for init in model.graph.initializer)
+        for node in model.graph.node:
+            if node.op_type == "GRU":
+                assert all(name in constants for name in node.input[1:4])
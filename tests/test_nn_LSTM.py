@@ -0,0 +1,72 @@
+# Copyright (c) 2021  PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License"
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+import paddle
+from onnxbase import APIOnnx
+from onnxbase import randtool
+
+
+class Net(paddle.nn.Layer):
+    """
+    simple Net
+    """
+
+    def __init__(self):
+        super(Net, self).__init__()
+        self._lstm = paddle.nn.LSTM(16, 32, 2, direction="bidirect")
+
+    def forward(self, inputs):
+        """
+        forward
+        """
+        x, (h, c) = self._lstm(inputs)
+        return x
+
+
+def constant_weight_inputs(model, op_type):
+    """
+    check W, R and B of the rnn nodes are constants
+    """
+    constants = set(init.name for init in model.graph.initializer)
+    for node in model.graph.node:
+        if node.op_type == "Constant":
+            constants.update(node.output)
+    rnn_nodes = [node for node in model.graph.node if node.op_type == op_type]
+    assert len(rnn_nodes) > 0
+    for node in rnn_nodes:
+        for name in node.input[1:4]:
+            if name not in constants:
+                return False
+    return True
+
+
+def test_LSTM_bidirect():
+    """
+    api: paddle.nn.LSTM
+    op version: 9, 11, 12
+    """
+    op = Net()
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'nn_LSTM', [9, 11, 12], delta=1e-5, rtol=1e-5)
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(
+            randtool("float", -1, 1, [4, 23, 16]).astype('float32')))
+    obj.set_export_options(enable_experimental_op=True)
+    obj.run()
+    # The gates are reordered and the directions are stacked while exporting
+    for ver in [9, 11, 12]:
+        model = obj.load_onnx_model(ver)
+        assert constant_weight_inputs(model, "LSTM")
+        assert "Concat" not in set(node.op_type for node in model.graph.node)
@@ -0,0 +1,105 @@
+# Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License"
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+import numpy as np
+import onnx
+import paddle
+from onnxruntime import InferenceSession
+from paddle.fluid.proto import framework_pb2
+from paddle2onnx.command import c_paddle_to_onnx
+from onnxbase import compare
+from onnxbase import randtool
+
+
+class Net(paddle.nn.Layer):
+    """
+    main head and auxiliary head
+    """
+
+    def __init__(self):
+        super(Net, self).__init__()
+        self._backbone = paddle.nn.Linear(16, 10)
+        self._head = paddle.nn.Linear(10, 5)
+        self._aux_head = paddle.nn.Linear(10, 7)
+
+    def forward(self, inputs):
+        """
+        forward
+        """
+        x = paddle.nn.functional.relu(self._backbone(inputs))
+        aux = paddle.nn.functional.sigmoid(self._aux_head(x))
+        return self._head(x), aux
+
+
+def remove_fetch(model_file, col):
+    """
+    remove the fetch operator of column `col`, the operators of this output
+    become dead in the saved program
+    """
+    prog = framework_pb2.ProgramDesc()
+    with open(model_file, "rb") as f:
+        prog.ParseFromString(f.read())
+    block = prog.blocks[0]
+    for i in range(len(block.ops)):
+        op = block.ops[i]
+        attrs = {attr.name: attr for attr in op.attrs}
+        if op.type == "fetch" and attrs["col"].i == col:
+            del block.ops[i]
+            break
+    with open(model_file, "wb") as f:
+        f.write(prog.SerializeToString())
+
+
+def test_prune_dead_ops():
+    """
+    api: dead operators pruning
+    op version: 9, 11, 13
+    """
+    net = Net()
+    net.eval()
+    data = randtool("float", -1, 1, [3, 16]).astype('float32')
+    expect = net(paddle.to_tensor(data))[0]
+
+    save_path = os.path.join(os.getcwd(), "prune_dead_ops", "model")
+    paddle.jit.save(
+        net,
+        save_path,
+        input_spec=[
+            paddle.static.InputSpec(
+                shape=[-1, 16], dtype='float32', name='x')
+        ])
+    remove_fetch(save_path + ".pdmodel", 1)
+
+    for ver in [9, 11, 13]:
+        onnx_model_str = c_paddle_to_onnx(
+            model_file=save_path + ".pdmodel",
+            params_file=save_path + ".pdiparams",
+            opset_version=ver,
+            auto_upgrade_opset=False,
+            verbose=False,
+            enable_optimize=False)
+        # the weight [10, 7] of auxiliary head is neither loaded nor exported,
+        # the dead end nodes are not eliminated by the optimizer here
+        model = onnx.load_from_string(onnx_model_str)
+        tensors = list(model.graph.initializer)
+        for node in model.graph.node:
+            tensors.extend(
+                [attr.t for attr in node.attribute if attr.name == "value"])
+        assert [10, 7] not in [list(tensor.dims) for tensor in tensors]
+        assert len(model.graph.output) == 1
+
+        sess = InferenceSession(onnx_model_str)
+        result = sess.run(output_names=None, input_feed={"x": data})
+        compare(result, expect.numpy(), delta=1e-5, rtol=1e-5)
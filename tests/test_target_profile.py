@@ -0,0 +1,123 @@
+# Copyright (c) 2021  PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License"
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+import paddle
+from onnxbase import APIOnnx
+from onnxbase import randtool
+
+
+class Net(paddle.nn.Layer):
+    """
+    simple Net
+    """
+
+    def __init__(self, activation):
+        super(Net, self).__init__()
+        self.activation = activation
+
+    def forward(self, inputs):
+        """
+        forward
+        """
+        x = self.activation(inputs)
+        return x
+
+
+def activation_api(name, activation, ver_list, target_profile):
+    """
+    export the activation with the target profile, returns the (domain,
+    op_type) of the exported operators in each opset version
+    """
+    op = Net(activation)
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, name, ver_list)
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(
+            randtool("float", -4, 4, [3, 10, 10]).astype('float32')))
+    obj.set_export_options(target_profile=target_profile)
+    obj.run()
+    result = dict()
+    for ver in ver_list:
+        model = obj.load_onnx_model(ver)
+        domains = [opset.domain for opset in model.opset_import]
+        assert ("com.microsoft" in domains) == (
+            target_profile == "onnxruntime-cpu")
+        result[ver] = [(node.domain, node.op_type)
+                       for node in model.graph.node]
+    return result
+
+
+def test_gelu_onnxruntime_cpu():
+    """
+    api: paddle.nn.functional.gelu
+    op version: 9, 11, 13
+    """
+    result = activation_api('gelu_onnxruntime_cpu',
+                            paddle.nn.functional.gelu, [9, 11, 13],
+                            "onnxruntime-cpu")
+    for nodes in result.values():
+        assert ("com.microsoft", "Gelu") in nodes
+        assert ("", "Erf") not in nodes
+
+
+def test_gelu_approximate_onnxruntime_cpu():
+    """
+    api: paddle.nn.functional.gelu
+    op version: 9, 11, 13
+    """
+    result = activation_api(
+        'gelu_approximate_onnxruntime_cpu',
+        lambda x: paddle.nn.functional.gelu(x, approximate=True), [9, 11, 13],
+        "onnxruntime-cpu")
+    for nodes in result.values():
+        assert ("com.microsoft", "FastGelu") in nodes
+
+
+def test_gelu_standard():
+    """
+    api: paddle.nn.functional.gelu
+    op version: 9, 11, 13
+    """
+    result = activation_api('gelu_standard', paddle.nn.functional.gelu,
+                            [9, 11, 13], "standard")
+    for nodes in result.values():
+        assert all(domain == "" for domain, op_type in nodes)
+        assert ("", "Erf") in nodes
+
+
+def test_swish_onnxruntime_cpu():
+    """
+    api: paddle.nn.functional.swish
+    op version: 7, 11, 13
+    """
+    result = activation_api('swish_onnxruntime_cpu',
+                            paddle.nn.functional.swish, [7, 11, 13],
+                            "onnxruntime-cpu")
+    for nodes in result.values():
+        assert ("com.microsoft", "QuickGelu") in nodes
+
+
+def test_hardswish_standard():
+    """
+    api: paddle.nn.functional.hardswish
+    op version: 7, 11, 13
+    """
+    result = activation_api('hardswish_standard',
+                            paddle.nn.functional.hardswish, [7, 11, 13],
+                            "standard")
+    # x * HardSigmoid(x) instead of the Add/Clip/Mul/Div chain
+    for nodes in result.values():
+        op_types = [op_type for domain, op_type in nodes]
+        assert "HardSigmoid" in op_types and "Clip" not in op_types
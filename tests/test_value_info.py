@@ -0,0 +1,121 @@
+# Copyright (c) 2021  PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License"
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+import paddle
+from onnxbase import APIOnnx
+from onnxbase import randtool
+
+
+class Net(paddle.nn.Layer):
+    """
+    simple Net
+    """
+
+    def __init__(self):
+        super(Net, self).__init__()
+        self._linear = paddle.nn.Linear(16, 32)
+
+    def forward(self, inputs):
+        """
+        forward
+        """
+        x = paddle.nn.functional.relu(self._linear(inputs))
+        return paddle.scale(x, scale=2.0, bias=1.0)
+
+
+def get_dims(value_info):
+    """
+    dim_value or dim_param of each dimension
+    """
+    dims = list()
+    for dim in value_info.type.tensor_type.shape.dim:
+        assert dim.HasField("dim_value") or dim.HasField("dim_param")
+        dims.append(dim.dim_param if dim.HasField("dim_param") else
+                    dim.dim_value)
+    return dims
+
+
+def value_info_api(name, **options):
+    """
+    export the Net with dynamic batch size and sequence length
+    """
+    op = Net()
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, name, [11, 13], input_spec_shape=[[-1, -1, 16]])
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(
+            randtool("float", -1, 1, [3, 10, 16]).astype('float32')))
+    obj.set_export_options(**options)
+    obj.run()
+    return obj
+
+
+def test_value_info():
+    """
+    api: paddle.nn.Linear, paddle.nn.functional.relu, paddle.scale
+    op version: 11, 13
+    """
+    obj = value_info_api('value_info')
+    for ver in [11, 13]:
+        graph = obj.load_onnx_model(ver).graph
+        value_infos = dict((value.name, value) for value in graph.value_info)
+        outputs = set(value.name for value in graph.output)
+        # Every intermediate tensor is described
+        for node in graph.node:
+            for name in node.output:
+                if name in outputs:
+                    continue
+                assert name in value_infos, name
+                assert value_infos[name].type.tensor_type.elem_type != 0
+                get_dims(value_infos[name])
+        # The dynamic dimensions are named, and shape inference propagates
+        # the symbols of the input to the output
+        input_dims = get_dims(graph.input[0])
+        assert isinstance(input_dims[0], str) and isinstance(input_dims[1],
+                                                             str)
+        assert input_dims[0] != input_dims[1]
+        assert get_dims(graph.output[0]) == input_dims[:2] + [32]
+
+
+def test_dim_params():
+    """
+    api: paddle.nn.Linear, paddle.nn.functional.relu, paddle.scale
+    op version: 11, 13
+    """
+    obj = value_info_api(
+        'dim_params', dim_params={"0": ["batch", "seq_len", ""]})
+    for ver in [11, 13]:
+        graph = obj.load_onnx_model(ver).graph
+        assert get_dims(graph.input[0]) == ["batch", "seq_len", 16]
+        assert get_dims(graph.output[0]) == ["batch", "seq_len", 32]
+        for value_info in graph.value_info:
+            dims = get_dims(value_info)
+            if len(dims) == 3:
+                assert dims[:2] == ["batch", "seq_len"]
+
+
+def test_dim_params_partial():
+    """
+    api: paddle.nn.Linear, paddle.nn.functional.relu, paddle.scale
+    op version: 11, 13
+    """
+    # The dimension with empty name is named automatically
+    obj = value_info_api(
+        'dim_params_partial', dim_params={"0": ["batch", "", ""]})
+    for ver in [11, 13]:
+        graph = obj.load_onnx_model(ver).graph
+        input_dims = get_dims(graph.input[0])
+        assert input_dims[0] == "batch" and input_dims[1].startswith("unk__")
+        assert get_dims(graph.output[0]) == input_dims[:2] + [32]
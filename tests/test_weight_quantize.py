@@ -0,0 +1,236 @@
+# Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License"
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import numpy as np
+import paddle
+from onnxbase import APIOnnx
+from onnxbase import randtool
+
+
+def int8_weight(shape, axis=None):
+    """
+    weight exactly representable by int8, every row and column holds the max
+    value 127, and the channels along axis are in different scales
+    """
+    weight = np.random.randint(-127, 128, shape)
+    for i in range(max(shape)):
+        weight[i % shape[0], i % shape[1]] = 127
+    weight = weight * 0.002
+    if axis is not None:
+        factor = 1 + np.arange(shape[axis]) % 4
+        weight = weight * (factor.reshape([-1, 1]) if axis == 0 else factor)
+    return weight.astype('float32')
+
+
+def int4_weight(shape):
+    """
+    weight [K, N] exactly representable by the int4 blocks of MatMulNBits,
+    every 32 elements of a column along K hold the max value 7
+    """
+    weight = np.random.randint(-7, 8, shape)
+    for j in range(shape[1]):
+        for i in range(j % 32, shape[0], 32):
+            weight[i, j] = 7
+    return (weight * 0.05).astype('float32')
+
+
+class LinearNet(paddle.nn.Layer):
+    """
+    Linear exported as Gemm with bias
+    """
+
+    def __init__(self, weight):
+        super(LinearNet, self).__init__()
+        self._linear = paddle.nn.Linear(weight.shape[0], weight.shape[1])
+        self._linear.weight.set_value(weight)
+
+    def forward(self, inputs):
+        """
+        forward
+        """
+        return self._linear(inputs)
+
+
+class TransposeNet(paddle.nn.Layer):
+    """
+    matmul with transposed weight [N, K]
+    """
+
+    def __init__(self, weight):
+        super(TransposeNet, self).__init__()
+        self.weight = self.create_parameter(
+            shape=weight.shape, dtype='float32')
+        self.weight.set_value(weight)
+
+    def forward(self, inputs):
+        """
+        forward
+        """
+        return paddle.matmul(inputs, self.weight, transpose_y=True)
+
+
+class EmbeddingNet(paddle.nn.Layer):
+    """
+    embedding table quantized per row
+    """
+
+    def __init__(self, weight):
+        super(EmbeddingNet, self).__init__()
+        self._embedding = paddle.nn.Embedding(weight.shape[0],
+                                              weight.shape[1])
+        self._embedding.weight.set_value(weight)
+
+    def forward(self, inputs):
+        """
+        forward
+        """
+        return self._embedding(inputs)
+
+
+def test_weight_quantize_int8_linear():
+    """
+    api: paddle.nn.Linear
+    op version: 11
+    """
+    op = LinearNet(int8_weight([64, 48]))
+    op.eval()
+    # onnxruntime quantizes the activations of DequantizeLinear + MatMul
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'weight_quantize_int8', [11], delta=5e-2, rtol=5e-2)
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(randtool("float", -1, 1, [3, 64]).astype('float32')))
+    obj.set_export_options(
+        weight_quantize_type="int8", weight_quantize_threshold=1024)
+    obj.run()
+
+
+def test_weight_quantize_int8_linear_per_channel():
+    """
+    api: paddle.nn.Linear
+    op version: 13, 15
+    """
+    op = LinearNet(int8_weight([64, 48], axis=1))
+    op.eval()
+    # onnxruntime quantizes the activations of DequantizeLinear + MatMul
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(
+        op, 'weight_quantize_int8', [13, 15], delta=5e-2, rtol=5e-2)
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(randtool("float", -1, 1, [3, 64]).astype('float32')))
+    obj.set_export_options(
+        weight_quantize_type="int8", weight_quantize_threshold=1024)
+    obj.run()
+
+
+def test_weight_quantize_int8_transpose():
+    """
+    api: paddle.matmul
+    op version: 13
+    """
+    op = TransposeNet(int8_weight([48, 64], axis=0))
+    op.eval()
+    # onnxruntime quantizes the activations of DequantizeLinear + MatMul
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'weight_quantize_int8', [13], delta=5e-2, rtol=5e-2)
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(randtool("float", -1, 1, [3, 64]).astype('float32')))
+    obj.set_export_options(
+        weight_quantize_type="int8", weight_quantize_threshold=1024)
+    obj.run()
+
+
+def test_weight_quantize_int8_embedding():
+    """
+    api: paddle.nn.Embedding
+    op version: 13
+    """
+    op = EmbeddingNet(int8_weight([100, 32], axis=0))
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'weight_quantize_int8', [13], delta=1e-4, rtol=1e-4)
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(randtool("int", 0, 100, [3, 5]).astype('int64')))
+    obj.set_export_options(
+        weight_quantize_type="int8", weight_quantize_threshold=1024)
+    obj.run()
+
+
+def test_weight_quantize_int4_linear():
+    """
+    api: paddle.nn.Linear
+    op version: 13
+    """
+    op = LinearNet(int4_weight([64, 48]))
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'weight_quantize_int4', [13], delta=1e-4, rtol=1e-4)
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(randtool("float", -1, 1, [3, 64]).astype('float32')))
+    obj.set_export_options(
+        target_profile="onnxruntime-cpu",
+        weight_quantize_type="int4",
+        weight_quantize_threshold=1024)
+    obj.run()
+
+
+def test_weight_quantize_int4_transpose():
+    """
+    api: paddle.matmul
+    op version: 13
+    """
+    op = TransposeNet(int4_weight([64, 48]).T.copy())
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'weight_quantize_int4', [13], delta=1e-4, rtol=1e-4)
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(randtool("float", -1, 1, [3, 64]).astype('float32')))
+    obj.set_export_options(
+        target_profile="onnxruntime-cpu",
+        weight_quantize_type="int4",
+        weight_quantize_threshold=1024)
+    obj.run()
+
+
+def test_weight_quantize_int4_linear_fp16():
+    """
+    api: paddle.nn.Linear
+    op version: 13
+    """
+    op = LinearNet(int4_weight([64, 48]))
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(
+        op, 'weight_quantize_int4_fp16', [13], delta=5e-2, rtol=1e-2)
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(randtool("float", -1, 1, [3, 64]).astype('float32')))
+    obj.set_export_options(
+        target_profile="onnxruntime-cpu",
+        weight_quantize_type="int4",
+        weight_quantize_threshold=1024,
+        export_fp16_model=True)
+    obj.run()
+    # The float32 output of MatMulNBits is casted before adding the bias
+    op_types = [
+        node.op_type for node in obj.load_onnx_model(13).graph.node
+        if node.op_type != "Constant"
+    ]
+    index = op_types.index("MatMulNBits")
+    assert op_types[index + 1:index + 3] == ["Cast", "Add"]
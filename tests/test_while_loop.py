@@ -0,0 +1,163 @@
+# Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License"
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import paddle
+from onnxbase import APIOnnx
+from onnxbase import randtool
+
+
+class CounterNet(paddle.nn.Layer):
+    """
+    while loop with a counter and a constant limit
+    """
+
+    def __init__(self):
+        super(CounterNet, self).__init__()
+        self.weight = self.create_parameter(shape=[10, 10], dtype='float32')
+
+    def forward(self, inputs):
+        """
+        forward
+        """
+        i = paddle.full(shape=[1], fill_value=0, dtype='int64')
+        n = paddle.full(shape=[1], fill_value=4, dtype='int64')
+
+        def cond(i, x):
+            return i < n
+
+        def body(i, x):
+            # the loop invariant tanh is hoisted out of the loop body
+            x = paddle.tanh(paddle.matmul(x, paddle.tanh(self.weight)))
+            return [i + 1, x]
+
+        i, x = paddle.static.nn.while_loop(cond, body, [i, inputs])
+        return x
+
+
+class NestedNet(paddle.nn.Layer):
+    """
+    while loop with another while loop in its body
+    """
+
+    def __init__(self):
+        super(NestedNet, self).__init__()
+        self.weight = self.create_parameter(shape=[10, 10], dtype='float32')
+
+    def forward(self, inputs):
+        """
+        forward
+        """
+        i = paddle.full(shape=[1], fill_value=0, dtype='int64')
+        n = paddle.full(shape=[1], fill_value=3, dtype='int64')
+        m = paddle.full(shape=[1], fill_value=2, dtype='int64')
+
+        def inner_cond(j, x):
+            return j < m
+
+        def inner_body(j, x):
+            x = paddle.tanh(paddle.matmul(x, self.weight * 0.5))
+            return [j + 1, x]
+
+        def cond(i, x):
+            return i < n
+
+        def body(i, x):
+            j = paddle.full(shape=[1], fill_value=0, dtype='int64')
+            j, x = paddle.static.nn.while_loop(inner_cond, inner_body, [j, x])
+            return [i + 1, x + 1.0]
+
+        i, x = paddle.static.nn.while_loop(cond, body, [i, inputs])
+        return x
+
+
+def loop_nodes(graph):
+    """
+    Loop nodes in the graph, the subgraphs are not included
+    """
+    return [node for node in graph.node if node.op_type == "Loop"]
+
+
+def test_while_loop_counter():
+    """
+    api: paddle.static.nn.while_loop
+    op version: 13, 14, 15
+    """
+    op = CounterNet()
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'while_loop', [13, 14, 15])
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(randtool("float", -1, 1, [3, 10]).astype('float32')))
+    obj.set_export_options(enable_experimental_op=True)
+    obj.run()
+
+
+def test_while_loop_nested():
+    """
+    api: paddle.static.nn.while_loop
+    op version: 13, 14, 15
+    """
+    op = NestedNet()
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'while_loop', [13, 14, 15])
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(randtool("float", -1, 1, [3, 10]).astype('float32')))
+    obj.set_export_options(enable_experimental_op=True)
+    obj.run()
+
+
+def test_while_loop_unroll():
+    """
+    api: paddle.static.nn.while_loop
+    op version: 13, 14, 15
+    """
+    op = CounterNet()
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'while_loop_unroll', [13, 14, 15])
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(randtool("float", -1, 1, [3, 10]).astype('float32')))
+    obj.set_export_options(
+        enable_experimental_op=True, loop_unroll_threshold=4)
+    obj.run()
+    for ver in [13, 14, 15]:
+        assert len(loop_nodes(obj.load_onnx_model(ver).graph)) == 0
+
+
+def test_while_loop_nested_unroll():
+    """
+    api: paddle.static.nn.while_loop
+    op version: 13, 14, 15
+    """
+    op = NestedNet()
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(op, 'while_loop_nested_unroll', [13, 14, 15])
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(randtool("float", -1, 1, [3, 10]).astype('float32')))
+    # only the inner loop with 2 iterations is unrolled, its limit is defined
+    # outside the outer loop
+    obj.set_export_options(
+        enable_experimental_op=True, loop_unroll_threshold=2)
+    obj.run()
+    for ver in [13, 14, 15]:
+        loops = loop_nodes(obj.load_onnx_model(ver).graph)
+        assert len(loops) == 1
+        body = [attr.g for attr in loops[0].attribute if attr.name == "body"]
+        assert len(body) == 1 and len(loop_nodes(body[0])) == 0
@@ -0,0 +1,112 @@
+# Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License"
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import paddle
+from onnxbase import APIOnnx
+from onnxbase import randtool
+
+
+class Net(paddle.nn.Layer):
+    """
+    simple Net
+    """
+
+    def __init__(self):
+        super(Net, self).__init__()
+
+    def forward(self, inputs, img_size):
+        """
+        forward
+        """
+        boxes, scores = paddle.vision.ops.yolo_box(
+            inputs,
+            img_size,
+            anchors=[10, 13, 16, 30, 33, 23],
+            class_num=2,
+            conf_thresh=0.01,
+            downsample_ratio=32,
+            clip_bbox=True,
+            scale_x_y=1.05)
+        return boxes, scores
+
+
+def op_types(model):
+    """
+    operator types of the graph
+    """
+    return set(node.op_type for node in model.graph.node)
+
+
+def yolo_box_api(input_spec_shape, **options):
+    """
+    export yolo_box with the input shapes
+    """
+    op = Net()
+    op.eval()
+    # net, name, ver_list, delta=1e-6, rtol=1e-5
+    obj = APIOnnx(
+        op,
+        'yolo_box', [11, 13],
+        input_spec_shape=input_spec_shape,
+        delta=1e-4,
+        rtol=1e-4)
+    obj.set_input_data(
+        "input_data",
+        paddle.to_tensor(
+            randtool("float", -1, 1, [2, 21, 8, 10]).astype('float32')),
+        paddle.to_tensor(randtool("int", 320, 640, [2, 2]).astype('int32')))
+    obj.set_export_options(enable_experimental_op=True, **options)
+    obj.run()
+    return obj
+
+
+def test_yolo_box_static():
+    """
+    api: paddle.vision.ops.yolo_box
+    op version: 11, 13
+    """
+    obj = yolo_box_api([])
+    # The grid and anchors are constants while H and W are known
+    for ver in [11, 13]:
+        types = op_types(obj.load_onnx_model(ver))
+        assert "Range" not in types and "Tile" not in types
+
+
+def test_yolo_box_dynamic():
+    """
+    api: paddle.vision.ops.yolo_box
+    op version: 11, 13
+    """
+    obj = yolo_box_api([[-1, 21, -1, -1], [-1, 2]])
+    for ver in [11, 13]:
+        assert "Range" in op_types(obj.load_onnx_model(ver))
+
+
+def test_yolo_box_input_shapes():
+    """
+    api: paddle.vision.ops.yolo_box
+    op version: 11, 13
+    """
+    # The dynamic dimensions are specialized while exporting
+    obj = yolo_box_api(
+        [[-1, 21, -1, -1], [-1, 2]],
+        input_shapes={"0": [2, 21, 8, 10],
+                      "1": [2, 2]})
+    for ver in [11, 13]:
+        model = obj.load_onnx_model(ver)
+        types = op_types(model)
+        assert "Range" not in types and "Tile" not in types
+        shapes = [[dim.dim_value for dim in value.type.tensor_type.shape.dim]
+                  for value in model.graph.input]
+        assert shapes == [[2, 21, 8, 10], [2, 2]]